@@ -0,0 +1,448 @@
+// Micro-benchmarks for the CPU hot paths. Each benchmark runs its body in a
+// calibrated loop, repeated several times, and reports the median time per
+// operation. Results can be written as JSON and compared against a saved
+// baseline, failing when anything regresses past a tolerance.
+
+#include "Common.hpp"
+#include "Renderer.hpp"
+#include "VectorMap.hpp"
+#include "TrajectoryCache.hpp"
+#include "MissilePool.hpp"
+#include "Aircraft.hpp"
+#include "GeoKernels.hpp"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Private access to the map's load stages, declared a friend by VectorMap
+class VectorMapBench {
+public:
+    static bool loadCoastlines(VectorMap& map, const std::string& path) { return map.loadCoastlines(path); }
+    static bool loadCountries(VectorMap& map, const std::string& path) { return map.loadCountries(path); }
+    static void buildLevelsOfDetail(VectorMap& map) {
+        map.buildLevelsOfDetail(map.m_coastlines);
+        map.buildLevelsOfDetail(map.m_borders);
+        map.buildLevelsOfDetail(map.m_russiaBorders);
+    }
+    static void clear(VectorMap& map) {
+        map.clearLayer(map.m_coastlines);
+        map.clearLayer(map.m_borders);
+        map.clearLayer(map.m_russiaBorders);
+    }
+    static size_t splitAtAntimeridian(VectorMap& map, const std::vector<Point>& points) {
+        map.clearLayer(map.m_coastlines);
+        map.m_coastlines.points.assign(points.begin(), points.end());
+        map.splitAtAntimeridian(map.m_coastlines, 0);
+        return map.m_coastlines.points.size();
+    }
+};
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the optimizer from discarding a result
+    template <typename T>
+    void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    // Loop state handed to a benchmark body
+    class State {
+    public:
+        explicit State(size_t iterations) : m_remaining(iterations), m_iterations(iterations) {}
+
+        bool keepRunning() {
+            if (m_remaining == m_iterations) m_start = Clock::now();
+            if (m_remaining == 0) {
+                m_elapsed += Clock::now() - m_start;
+                return false;
+            }
+            m_remaining--;
+            return true;
+        }
+
+        // Excludes per-iteration setup from the measurement
+        void pauseTiming() { m_elapsed += Clock::now() - m_start; }
+        void resumeTiming() { m_start = Clock::now(); }
+
+        void setItemsProcessed(uint64_t items) { m_items = items; }
+
+        size_t iterations() const { return m_iterations; }
+        uint64_t items() const { return m_items; }
+        double seconds() const { return std::chrono::duration<double>(m_elapsed).count(); }
+
+    private:
+        size_t m_remaining;
+        size_t m_iterations;
+        uint64_t m_items = 0;
+        Clock::time_point m_start;
+        Clock::duration m_elapsed{};
+    };
+
+    struct Benchmark {
+        std::string name;
+        std::function<void(State&)> body;
+        bool needsGL;
+    };
+
+    struct Result {
+        std::string name;
+        double nsPerOp;
+        double itemsPerSecond;
+        size_t iterations;
+    };
+
+    struct Options {
+        std::string filter;
+        double minTime = 0.25;
+        int repetitions = 5;
+        std::string jsonOut;
+        std::string baseline;
+        double tolerance = 0.10;
+    };
+
+    // Silences the loaders' progress output while they are being timed
+    class QuietOutput {
+    public:
+        QuietOutput() : m_saved(std::cout.rdbuf(m_null.rdbuf())) {}
+        ~QuietOutput() { std::cout.rdbuf(m_saved); }
+
+    private:
+        std::ostringstream m_null;
+        std::streambuf* m_saved;
+    };
+
+    std::string findDataFile(const std::string& filename) {
+        for (const char* base : {"data", "wargames_cpp/data", "../data", "../../data"}) {
+            std::filesystem::path path = std::filesystem::path(base) / filename;
+            if (std::filesystem::exists(path)) return path.string();
+        }
+        return filename;
+    }
+
+    Result runBenchmark(const Benchmark& bench, const Options& options) {
+        // Grow the iteration count until one run takes at least minTime
+        size_t iterations = 1;
+        for (;;) {
+            State state(iterations);
+            bench.body(state);
+            if (state.seconds() >= options.minTime || iterations >= (size_t{1} << 30)) break;
+            const double scale = state.seconds() > 0.0 ? options.minTime / state.seconds() * 1.2 : 10.0;
+            iterations = std::max(iterations + 1, static_cast<size_t>(iterations * std::min(scale, 10.0)));
+        }
+
+        std::vector<double> nsPerOp;
+        std::vector<double> itemsPerSecond;
+        for (int rep = 0; rep < options.repetitions; rep++) {
+            State state(iterations);
+            bench.body(state);
+            nsPerOp.push_back(state.seconds() * 1e9 / iterations);
+            itemsPerSecond.push_back(state.items() > 0 ? state.items() / state.seconds() : 0.0);
+        }
+
+        auto median = [](std::vector<double> values) {
+            std::sort(values.begin(), values.end());
+            return values[values.size() / 2];
+        };
+        return Result{bench.name, median(nsPerOp), median(itemsPerSecond), iterations};
+    }
+
+    void writeJson(const std::string& path, const std::vector<Result>& results) {
+        std::ofstream out(path, std::ios::trunc);
+        out << "{\"benchmarks\":[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            out << "{\"name\":\"" << r.name << "\",\"ns_per_op\":" << r.nsPerOp
+                << ",\"items_per_second\":" << r.itemsPerSecond
+                << ",\"iterations\":" << r.iterations << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]}\n";
+    }
+
+    // Reads the name and ns_per_op fields of a file written by writeJson
+    std::map<std::string, double> readBaseline(const std::string& path) {
+        std::map<std::string, double> baseline;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            const size_t nameAt = line.find("\"name\":\"");
+            const size_t nsAt = line.find("\"ns_per_op\":");
+            if (nameAt == std::string::npos || nsAt == std::string::npos) continue;
+            const size_t nameStart = nameAt + 8;
+            const size_t nameEnd = line.find('"', nameStart);
+            baseline[line.substr(nameStart, nameEnd - nameStart)] = std::atof(line.c_str() + nsAt + 12);
+        }
+        return baseline;
+    }
+
+    bool parseArgs(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(arg, "--filter") == 0 && hasValue) {
+                options.filter = argv[++i];
+            } else if (std::strcmp(arg, "--min-time") == 0 && hasValue) {
+                options.minTime = std::max(0.01, std::atof(argv[++i]));
+            } else if (std::strcmp(arg, "--repetitions") == 0 && hasValue) {
+                options.repetitions = std::max(1, std::atoi(argv[++i]));
+            } else if (std::strcmp(arg, "--json") == 0 && hasValue) {
+                options.jsonOut = argv[++i];
+            } else if (std::strcmp(arg, "--baseline") == 0 && hasValue) {
+                options.baseline = argv[++i];
+            } else if (std::strcmp(arg, "--tolerance") == 0 && hasValue) {
+                options.tolerance = std::max(0.0, std::atof(argv[++i]));
+            } else {
+                std::cout << "Usage: wargames_microbench [options]\n"
+                          << "  --filter <text>    Run only benchmarks whose name contains text\n"
+                          << "  --min-time <s>     Minimum seconds per repetition (default 0.25)\n"
+                          << "  --repetitions <n>  Repetitions; the median is reported (default 5)\n"
+                          << "  --json <file>      Write results as JSON\n"
+                          << "  --baseline <file>  Compare with a previous --json file\n"
+                          << "  --tolerance <f>    Allowed slowdown against the baseline (default 0.10)\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const LatLon NEW_YORK{40.7128, -74.0060};
+    const LatLon MOSCOW{55.7558, 37.6173};
+    const LatLon SYDNEY{-33.8688, 151.2093};
+    const LatLon LOS_ANGELES{34.0522, -118.2437};
+
+    // Closed ring that crosses the antimeridian every few points
+    std::vector<Point> wrappingRing(size_t count) {
+        std::vector<Point> points(count);
+        for (size_t i = 0; i < count; i++) {
+            float t = static_cast<float>(i) / (count - 1) * 6.2831853f;
+            float lon = 170.0f + 20.0f * std::cos(t * 8.0f);
+            if (lon > 180.0f) lon -= 360.0f;
+            points[i] = lonlat_to_world(lon, 40.0f * std::sin(t));
+        }
+        return points;
+    }
+
+    std::vector<Benchmark> buildBenchmarks(Renderer* renderer, bool haveGL) {
+        std::vector<Benchmark> benchmarks;
+
+        benchmarks.push_back({"TrajectoryCache::calculatePath/220", [](State& state) {
+            std::vector<Point> path(MissilePool::PATH_SAMPLES);
+            while (state.keepRunning()) {
+                TrajectoryCache::calculatePath(NEW_YORK, MOSCOW, MissilePool::PATH_SAMPLES, path.data());
+                doNotOptimize(path.data());
+            }
+            state.setItemsProcessed(state.iterations() * MissilePool::PATH_SAMPLES);
+        }, false});
+
+        benchmarks.push_back({"Aircraft::buildLoop/240", [](State& state) {
+            std::vector<Point> loops;
+            loops.reserve(Aircraft::LOOP_SAMPLES);
+            while (state.keepRunning()) {
+                loops.clear();
+                Aircraft craft(LatLon{10.0, 175.0}, 8.0, 30.0f, Colors::DIM_CYAN, loops);
+                doNotOptimize(craft);
+                doNotOptimize(loops.data());
+            }
+            state.setItemsProcessed(state.iterations() * Aircraft::LOOP_SAMPLES);
+        }, false});
+
+        benchmarks.push_back({"GeoKernels::projectPoints/10000", [](State& state) {
+            std::vector<double> lon(10000), lat(10000);
+            for (size_t i = 0; i < lon.size(); i++) {
+                lon[i] = -180.0 + 0.036 * i;
+                lat[i] = 60.0 * std::sin(0.01 * i);
+            }
+            std::vector<Point> points(lon.size());
+            while (state.keepRunning()) {
+                GeoKernels::projectPoints(lon.data(), lat.data(), lon.size(), points.data());
+                doNotOptimize(points.data());
+            }
+            state.setItemsProcessed(state.iterations() * lon.size());
+        }, false});
+
+        benchmarks.push_back({"GeoKernels::findAntimeridianBreaks/10000", [](State& state) {
+            const std::vector<Point> ring = wrappingRing(10000);
+            std::vector<uint32_t> breaks(ring.size());
+            while (state.keepRunning()) {
+                doNotOptimize(GeoKernels::findAntimeridianBreaks(ring.data(), ring.size(), breaks.data()));
+            }
+            state.setItemsProcessed(state.iterations() * ring.size());
+        }, false});
+
+        benchmarks.push_back({"MissilePool::update/1000", [](State& state) {
+            TrajectoryCache trajectories;
+            MissilePool missiles(trajectories, 1024);
+            const LatLon sites[] = {NEW_YORK, MOSCOW, SYDNEY, LOS_ANGELES};
+            for (int i = 0; i < 1000; i++) {
+                missiles.spawn(MissileType::Silo, sites[i % 4], sites[(i + 1) % 4], Colors::CYAN);
+            }
+            std::vector<Point> impacts;
+            while (state.keepRunning()) {
+                // Small enough that no missile finishes during the run
+                missiles.update(1e-7f, impacts);
+                doNotOptimize(impacts.data());
+            }
+            state.setItemsProcessed(state.iterations() * missiles.size());
+        }, false});
+
+        // CPU only: the map creates no GL objects until a layer is uploaded,
+        // so an uninitialized renderer serves as its owner
+        benchmarks.push_back({"VectorMap::splitAtAntimeridian/10000", [renderer](State& state) {
+            VectorMap map(renderer);
+            const std::vector<Point> ring = wrappingRing(10000);
+            while (state.keepRunning()) {
+                doNotOptimize(VectorMapBench::splitAtAntimeridian(map, ring));
+            }
+            state.setItemsProcessed(state.iterations() * ring.size());
+        }, false});
+
+        if (!haveGL) return benchmarks;
+
+        const std::string coastline = findDataFile("ne_110m_coastline.shp");
+        const std::string countries = findDataFile("ne_110m_admin_0_countries.shp");
+        if (std::filesystem::exists(coastline) && std::filesystem::exists(countries)) {
+            benchmarks.push_back({"VectorMap::loadShapefiles/110m", [renderer, coastline, countries](State& state) {
+                VectorMap map(renderer);
+                QuietOutput quiet;
+                while (state.keepRunning()) {
+                    VectorMapBench::clear(map);
+                    VectorMapBench::loadCoastlines(map, coastline);
+                    VectorMapBench::loadCountries(map, countries);
+                }
+            }, true});
+
+            benchmarks.push_back({"VectorMap::buildLevelsOfDetail/110m", [renderer, coastline, countries](State& state) {
+                VectorMap map(renderer);
+                QuietOutput quiet;
+                while (state.keepRunning()) {
+                    state.pauseTiming();
+                    VectorMapBench::clear(map);
+                    VectorMapBench::loadCoastlines(map, coastline);
+                    VectorMapBench::loadCountries(map, countries);
+                    state.resumeTiming();
+                    VectorMapBench::buildLevelsOfDetail(map);
+                }
+            }, true});
+        }
+
+        benchmarks.push_back({"Renderer::drawPath/100x220", [renderer](State& state) {
+            std::vector<Point> path(MissilePool::PATH_SAMPLES);
+            TrajectoryCache::calculatePath(NEW_YORK, SYDNEY, MissilePool::PATH_SAMPLES, path.data());
+            while (state.keepRunning()) {
+                renderer->beginBatch();
+                for (int i = 0; i < 100; i++) {
+                    renderer->submitPath(path.data(), path.size(), Colors::CYAN, 1.0f, 5);
+                }
+                renderer->flushBatch();
+            }
+            state.setItemsProcessed(state.iterations() * 100 * path.size());
+        }, true});
+
+        benchmarks.push_back({"MissilePool::draw/1000", [renderer](State& state) {
+            TrajectoryCache trajectories;
+            MissilePool missiles(trajectories, 1024);
+            const LatLon sites[] = {NEW_YORK, MOSCOW, SYDNEY, LOS_ANGELES};
+            for (int i = 0; i < 1000; i++) {
+                missiles.spawn(MissileType::Silo, sites[i % 4], sites[(i + 1) % 4], Colors::CYAN);
+            }
+            std::vector<Point> impacts;
+            missiles.update(6.0f, impacts);   // trails half drawn
+
+            // Zoomed on the North Atlantic so culling has work to do
+            MapView view;
+            view.centerLon = -30.0f;
+            view.centerLat = 45.0f;
+            view.zoom = 4.0f;
+            renderer->setView(view);
+            DrawList list;
+            while (state.keepRunning()) {
+                renderer->setupDrawList(list);
+                missiles.draw(list);
+                renderer->draw(list);
+            }
+            renderer->setView(MapView{});
+            state.setItemsProcessed(state.iterations() * missiles.size());
+        }, true});
+
+        return benchmarks;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        return 2;
+    }
+
+    // Renderer and map loading benchmarks need a context; without a display
+    // they are skipped
+    Renderer renderer(640, 360);
+    WindowSettings settings;
+    settings.vsync = false;
+    settings.hidden = true;
+    bool haveGL = false;
+    {
+        QuietOutput quiet;
+        haveGL = SDL_Init(SDL_INIT_VIDEO) == 0 && renderer.initialize(settings);
+    }
+    if (!haveGL) {
+        std::cerr << "No GL context available, skipping renderer and map loading benchmarks\n";
+    }
+
+    std::vector<Benchmark> benchmarks = buildBenchmarks(&renderer, haveGL);
+    std::vector<Result> results;
+
+    std::cout << "Geo kernels: " << GeoKernels::instructionSet() << "\n";
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(14) << "ns/op" << std::setw(16) << "items/s" << std::setw(12) << "iters" << "\n";
+    for (const Benchmark& bench : benchmarks) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) continue;
+        Result result = runBenchmark(bench, options);
+        std::cout << std::left << std::setw(40) << result.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << result.nsPerOp
+                  << std::setprecision(0) << std::setw(16) << result.itemsPerSecond
+                  << std::setw(12) << result.iterations << "\n";
+        results.push_back(result);
+    }
+
+    if (!options.jsonOut.empty()) writeJson(options.jsonOut, results);
+
+    int exitCode = 0;
+    if (!options.baseline.empty()) {
+        const std::map<std::string, double> baseline = readBaseline(options.baseline);
+        for (const Result& result : results) {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end() || it->second <= 0.0) continue;
+            const double ratio = result.nsPerOp / it->second;
+            if (ratio > 1.0 + options.tolerance) {
+                std::cerr << "REGRESSION " << result.name << ": " << std::setprecision(1)
+                          << result.nsPerOp << " ns/op vs baseline " << it->second
+                          << " (" << std::setprecision(0) << (ratio - 1.0) * 100.0 << "% slower)\n";
+                exitCode = 1;
+            }
+        }
+    }
+
+    if (haveGL) renderer.shutdown();
+    SDL_Quit();
+    return exitCode;
+}
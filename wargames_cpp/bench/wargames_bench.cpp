@@ -0,0 +1,233 @@
+// Headless, deterministic benchmark: runs a fixed scenario for a fixed
+// number of frames with a fixed seed and timestep, vsync and the frame
+// limiter off, and reports frame-time statistics and throughput.
+
+#include "Application.hpp"
+#include "AllocationCounter.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+    struct BenchOptions {
+        int frames = 1000;
+        int warmup = 60;
+        bool json = false;
+    };
+
+    void printUsage() {
+        std::cout << "Usage: wargames_bench [options]\n"
+                  << "  --frames <n>          Measured frames (default 1000)\n"
+                  << "  --warmup <n>          Frames run before measuring (default 60)\n"
+                  << "  --seed <n>            Random seed (default 1)\n"
+                  << "  --timestep <s>        Simulated seconds per frame (default 1/60)\n"
+                  << "  --sim-hz <n>          Simulation ticks per second (default 60)\n"
+                  << "  --missiles <n>        Missiles launched before the first frame (default 50)\n"
+                  << "  --launch-interval <s> Seconds between single launches (default 0.5)\n"
+                  << "  --burst-interval <s>  Seconds between 8-missile bursts, 0 = none (default 2)\n"
+                  << "  --crt <off|light|full> CRT post-processing mode (default full)\n"
+                  << "  --size <w>x<h>        Window size (default 1920x1080)\n"
+                  << "  --wall <c>x<r>        Split the view over c x r windows sharing one simulation\n"
+                  << "  --render-scale <s>    Scene resolution relative to the window\n"
+                  << "  --visible             Show the window instead of rendering hidden\n"
+                  << "  --vsync               Keep vsync on\n"
+                  << "  --single-thread       Step the simulation on the render thread\n"
+                  << "  --feed <source>       Launch from udp:<port>, a named pipe or a replay file\n"
+                  << "  --replay-speed <x>    Time scale of a replayed feed file (default 1)\n"
+                  << "  --phosphor <s>        Persistent trails fading to half in s seconds\n"
+                  << "  --gpu-trails          Draw trails from the GPU trajectory buffer\n"
+                  << "  --capture <target>    Record frames to a .y4m file, pipe:<command> or a %05d.png pattern\n"
+                  << "  --profile-out <f>     Also write profiler stats (.json or .csv)\n"
+                  << "  --json                Print the result as one JSON object\n";
+    }
+
+    bool parseArgs(int argc, char* argv[], AppConfig& config, BenchOptions& options) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (std::strcmp(arg, "--frames") == 0 && hasValue) {
+                options.frames = std::max(1, std::atoi(argv[++i]));
+            } else if (std::strcmp(arg, "--warmup") == 0 && hasValue) {
+                options.warmup = std::max(0, std::atoi(argv[++i]));
+            } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+                config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            } else if (std::strcmp(arg, "--timestep") == 0 && hasValue) {
+                config.fixedTimestep = std::max(1e-4f, static_cast<float>(std::atof(argv[++i])));
+            } else if (std::strcmp(arg, "--sim-hz") == 0 && hasValue) {
+                config.simulationHz = std::clamp(std::atoi(argv[++i]), 10, 1000);
+            } else if (std::strcmp(arg, "--missiles") == 0 && hasValue) {
+                config.initialMissiles = std::max(0, std::atoi(argv[++i]));
+            } else if (std::strcmp(arg, "--launch-interval") == 0 && hasValue) {
+                config.launchInterval = std::max(0.01f, static_cast<float>(std::atof(argv[++i])));
+            } else if (std::strcmp(arg, "--burst-interval") == 0 && hasValue) {
+                config.burstInterval = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+            } else if (std::strcmp(arg, "--crt") == 0 && hasValue) {
+                const std::string mode = argv[++i];
+                if (mode == "off") config.crtMode = CRTMode::OFF;
+                else if (mode == "light") config.crtMode = CRTMode::LIGHT;
+                else if (mode == "full") config.crtMode = CRTMode::FULL;
+                else {
+                    std::cerr << "Unknown CRT mode: " << mode << "\n";
+                    return false;
+                }
+            } else if (std::strcmp(arg, "--size") == 0 && hasValue) {
+                int width = 0, height = 0;
+                if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                    std::cerr << "Invalid size: " << argv[i] << "\n";
+                    return false;
+                }
+                config.width = width;
+                config.height = height;
+            } else if (std::strcmp(arg, "--wall") == 0 && hasValue) {
+                int columns = 0, rows = 0;
+                if (std::sscanf(argv[++i], "%dx%d", &columns, &rows) != 2 || columns <= 0 || rows <= 0) {
+                    std::cerr << "Invalid wall layout: " << argv[i] << "\n";
+                    return false;
+                }
+                config.wallColumns = std::min(columns, 16);
+                config.wallRows = std::min(rows, 16);
+            } else if (std::strcmp(arg, "--render-scale") == 0 && hasValue) {
+                config.renderScale = std::clamp(static_cast<float>(std::atof(argv[++i])), 0.25f, 4.0f);
+            } else if (std::strcmp(arg, "--visible") == 0) {
+                config.hiddenWindow = false;
+            } else if (std::strcmp(arg, "--vsync") == 0) {
+                config.vsync = true;
+            } else if (std::strcmp(arg, "--single-thread") == 0) {
+                config.threadedSimulation = false;
+            } else if (std::strcmp(arg, "--feed") == 0 && hasValue) {
+                config.feed = argv[++i];
+            } else if (std::strcmp(arg, "--replay-speed") == 0 && hasValue) {
+                config.replaySpeed = std::max(0.01f, static_cast<float>(std::atof(argv[++i])));
+            } else if (std::strcmp(arg, "--phosphor") == 0 && hasValue) {
+                config.phosphorHalfLife = std::clamp(static_cast<float>(std::atof(argv[++i])), 0.05f, 60.0f);
+            } else if (std::strcmp(arg, "--gpu-trails") == 0) {
+                config.gpuTrails = true;
+            } else if (std::strcmp(arg, "--capture") == 0 && hasValue) {
+                config.capture = argv[++i];
+            } else if (std::strcmp(arg, "--profile-out") == 0 && hasValue) {
+                config.profileOut = argv[++i];
+            } else if (std::strcmp(arg, "--json") == 0) {
+                options.json = true;
+            } else {
+                if (std::strcmp(arg, "--help") != 0) std::cerr << "Unknown option: " << arg << "\n";
+                printUsage();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        const size_t index = static_cast<size_t>(std::ceil(p * sorted.size())) - 1;
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+}
+
+int main(int argc, char* argv[]) {
+    AppConfig config;
+    config.vsync = false;
+    config.frameLimit = false;
+    config.hiddenWindow = true;
+    config.acceptInput = false;
+    config.crtMode = CRTMode::FULL;
+    config.fixedSeed = true;
+    config.seed = 1;
+    config.fixedTimestep = 1.0f / 60.0f;
+    config.initialMissiles = 50;
+    config.launchInterval = 0.5f;
+    config.burstInterval = 2.0f;
+
+    BenchOptions options;
+    if (!parseArgs(argc, argv, config, options)) {
+        return 2;
+    }
+    config.maxFrames = options.warmup + options.frames;
+
+    Application app(config);
+    if (!app.initialize()) {
+        return 1;
+    }
+    int result = app.run();
+    // Shutting down first drains the capture into the stats
+    app.shutdown();
+    const RunStats stats = app.stats();
+    if (result != 0) return result;
+
+    // Only the frames after the warmup count
+    const size_t skip = std::min(static_cast<size_t>(options.warmup), stats.frameMs.size());
+    std::vector<double> frameMs(stats.frameMs.begin() + skip, stats.frameMs.end());
+    if (frameMs.empty()) {
+        std::cerr << "No frames measured\n";
+        return 1;
+    }
+    const uint64_t missileUpdates = std::accumulate(stats.liveMissiles.begin() + skip,
+                                                    stats.liveMissiles.end(), uint64_t{0});
+
+    // Steady-state frames should allocate nothing; only counted in builds
+    // with WARGAMES_COUNT_ALLOCATIONS
+    const bool countAllocations = AllocationCounter::isEnabled();
+    const size_t allocationSkip = std::min(skip, stats.allocations.size());
+    const uint64_t allocations = std::accumulate(stats.allocations.begin() + allocationSkip,
+                                                 stats.allocations.end(), uint64_t{0});
+    const uint32_t maxFrameAllocations = (allocationSkip < stats.allocations.size())
+        ? *std::max_element(stats.allocations.begin() + allocationSkip, stats.allocations.end()) : 0;
+
+    const double totalMs = std::accumulate(frameMs.begin(), frameMs.end(), 0.0);
+    std::sort(frameMs.begin(), frameMs.end());
+    const double avgMs = totalMs / frameMs.size();
+    const double fps = frameMs.size() * 1000.0 / totalMs;
+    const double missilesPerSecond = missileUpdates * 1000.0 / totalMs;
+
+    if (options.json) {
+        std::cout << "{\"frames\":" << frameMs.size()
+                  << ",\"min_ms\":" << frameMs.front()
+                  << ",\"avg_ms\":" << avgMs
+                  << ",\"p50_ms\":" << percentile(frameMs, 0.50)
+                  << ",\"p99_ms\":" << percentile(frameMs, 0.99)
+                  << ",\"max_ms\":" << frameMs.back()
+                  << ",\"fps\":" << fps
+                  << ",\"missile_updates_per_s\":" << missilesPerSecond
+                  << ",\"missiles_launched\":" << stats.missilesLaunched
+                  << ",\"feed_records\":" << stats.feed.parsed
+                  << ",\"feed_rejected\":" << stats.feed.rejected
+                  << ",\"feed_dropped\":" << stats.feed.dropped
+                  << ",\"capture_written\":" << stats.capture.written
+                  << ",\"capture_dropped\":" << stats.capture.dropped;
+        if (countAllocations) {
+            std::cout << ",\"allocations\":" << allocations
+                      << ",\"max_frame_allocations\":" << maxFrameAllocations;
+        }
+        std::cout << "}\n";
+    } else {
+        std::cout << "\nBenchmark: " << frameMs.size() << " frames after " << skip << " warmup\n"
+                  << "  frame min " << frameMs.front() << " ms, avg " << avgMs
+                  << " ms, p50 " << percentile(frameMs, 0.50)
+                  << " ms, p99 " << percentile(frameMs, 0.99)
+                  << " ms, max " << frameMs.back() << " ms\n"
+                  << "  throughput " << fps << " fps, " << missilesPerSecond << " missile updates/s\n"
+                  << "  missiles launched " << stats.missilesLaunched << "\n";
+        if (!config.feed.empty()) {
+            std::cout << "  feed " << stats.feed.parsed << " records, " << stats.feed.rejected
+                      << " rejected, " << stats.feed.dropped << " dropped\n";
+        }
+        if (!config.capture.empty()) {
+            std::cout << "  capture " << stats.capture.written << " frames written, "
+                      << stats.capture.dropped << " dropped\n";
+        }
+        if (countAllocations) {
+            std::cout << "  allocations " << allocations << " in measured frames, at most "
+                      << maxFrameAllocations << " in one frame\n";
+        }
+    }
+
+    return 0;
+}
@@ -1,22 +1,33 @@
 #pragma once
 
 #include "Common.hpp"
-#include "Renderer.hpp"
+#include "DrawList.hpp"
+#include <cstdint>
 #include <vector>
 
 class Aircraft {
 public:
-    Aircraft(const LatLon& center, double radiusDeg, float loopSeconds, const Color& color);
+    static constexpr int LOOP_SAMPLES = 240;
+
+    // The loop is appended to loops, which is shared with the other aircraft
+    // and must outlive this one; it may keep growing, since the aircraft
+    // addresses its samples by index
+    Aircraft(const LatLon& center, double radiusDeg, float loopSeconds, const Color& color,
+             std::vector<Point>& loops);
 
     void update(float dt);
-    void draw(Renderer* renderer) const;
+    // alpha in [0, 1] blends from the previous tick's position to the current one
+    void draw(DrawList& list, float alpha = 1.0f) const;
 
 private:
-    std::vector<Point> m_path;
+    const std::vector<Point>* m_loops;
+    uint32_t m_first;   // first loop sample in m_loops
+    uint32_t m_count;
     Color m_color;
     float m_progress;
+    float m_prevProgress;
     float m_duration;
     int m_trailLength;
 
-    void buildLoop(const LatLon& center, double radiusDeg, int samples = 240);
+    void buildLoop(std::vector<Point>& loops, const LatLon& center, double radiusDeg, int samples = LOOP_SAMPLES);
 };
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Debug counter of heap allocations, for checking that steady-state frames
+// allocate nothing. Configured with -DWARGAMES_COUNT_ALLOCATIONS=ON, this
+// replaces the global operator new to count every call on any thread;
+// otherwise it compiles to nothing and count() stays 0.
+namespace AllocationCounter {
+    bool isEnabled();
+
+    // operator new calls since the process started
+    uint64_t count();
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Renderer.hpp"
+#include "ShaderProgram.hpp"
+#include "VectorMap.hpp"
+#include "JobSystem.hpp"
+#include "Simulation.hpp"
+#include "BloomChain.hpp"
+#include "Profiler.hpp"
+#include "PerfHud.hpp"
+#include "FrameCapture.hpp"
+#include "ShaderWatcher.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// CRT mode
+enum class CRTMode {
+    OFF,
+    LIGHT,
+    FULL
+};
+
+// Everything that decides how a run behaves. The simulation always advances
+// in fixed ticks; the interactive defaults feed it wall-clock time, while a
+// benchmark fixes the seed and frame timestep and turns off vsync and the
+// frame limiter so runs are repeatable.
+struct AppConfig {
+    // Window and pipeline
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    float renderScale = 1.0f;
+    bool vsync = true;
+    bool frameLimit = true;         // without vsync, wait out each frame to hold targetFps
+    int targetFps = 60;
+    bool hiddenWindow = false;      // render with a context whose window is never shown
+    CRTMode crtMode = CRTMode::OFF;
+    std::string shaderDir;          // empty searches the usual locations
+    bool shaderCache = true;        // keep linked program binaries on disk between runs
+    std::string shaderCacheDir;     // empty uses $XDG_CACHE_HOME/wargames_cpp/programs
+    bool shaderHotReload = false;   // relink post-processing shaders when their files change
+    float phosphorHalfLife = 0.0f;  // seconds for a persistent trail to fade to half; 0 redraws trails every frame
+    bool gpuTrails = false;         // draw redrawn trails from a GPU copy of the trajectories
+    int wallColumns = 1;            // display wall: the view split into columns x rows windows,
+    int wallRows = 1;               // fullscreen on one display each when there are enough
+
+    // Simulation
+    bool fixedSeed = false;
+    uint32_t seed = 0;
+    int simulationHz = 60;          // simulation ticks per second, independent of the frame rate
+    float fixedTimestep = 0.0f;     // simulated seconds per frame; 0 follows the wall clock
+    float launchInterval = 2.0f;    // seconds between single launches
+    float burstInterval = 0.0f;     // seconds between automatic bursts; 0 = SPACE only
+    int initialMissiles = 0;        // launched before the first frame
+    int aircraftCount = 12;
+    std::string feed;               // launch feed (see ScenarioFeed); replaces the random launch timer
+    float replaySpeed = 1.0f;       // time scale of a replayed feed file
+    bool threadedSimulation = true; // step the simulation on its own thread, one frame ahead
+
+    // Run control
+    int maxFrames = 0;              // 0 runs until quit
+    bool acceptInput = true;
+    std::string profileOut;
+    std::string capture;            // record the composited frames (see FrameCapture)
+};
+
+// Per-frame measurements of a run, recorded when maxFrames is set
+struct RunStats {
+    std::vector<double> frameMs;    // wall time of every frame
+    std::vector<uint32_t> liveMissiles;
+    std::vector<uint32_t> allocations;  // heap allocations per frame, when AllocationCounter is enabled
+    uint64_t missilesLaunched = 0;
+    double seconds = 0.0;
+    ScenarioFeed::Stats feed;
+    FrameCapture::Stats capture;
+};
+
+// Owns the window, the simulation and the render pipeline, and runs the
+// main loop
+class Application {
+public:
+    explicit Application(const AppConfig& config);
+    ~Application();
+
+    Application(const Application&) = delete;
+    Application& operator=(const Application&) = delete;
+
+    bool initialize();
+    // Runs until quit or config.maxFrames; returns the process exit code
+    int run();
+    void shutdown();
+
+    const RunStats& stats() const { return m_stats; }
+
+private:
+    AppConfig m_config;
+    std::string m_shaderDir;        // with a trailing separator
+
+    Renderer m_renderer;
+    VectorMap m_vectorMap;
+    MapView m_view;
+    BloomPrograms m_bloomPrograms;  // shared by every output's chain
+    Profiler m_profiler;
+    PerfHud m_perfHud;
+    ShaderWatcher m_shaderWatcher;
+    FrameCapture m_capture;
+
+    // Offscreen scene target, sized to the window times the render scale
+    struct SceneTarget {
+        GLuint fbo = 0;
+        GLuint texture = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    // One window showing one tile of m_view, with its own post-processing.
+    // Every output draws through the renderer's single GL context, so the
+    // map, meshes, programs and trajectory buffer exist once however many
+    // windows there are; an output only owns its targets. m_outputs[0] is
+    // the renderer's own window.
+    struct Output {
+        Output(Renderer* renderer, const BloomPrograms* bloomPrograms) : bloom(renderer, bloomPrograms) {}
+
+        SDL_Window* window = nullptr;
+        ViewTile tile;
+        int width = 0;              // drawable size the targets were made for
+        int height = 0;
+        SceneTarget scene;
+        // Phosphor persistence: trails accumulate here and are faded instead
+        // of being redrawn. Half-float, so a long fade does not stall on 8-bit
+        // rounding. Only allocated while the mode is on.
+        SceneTarget trails;
+        double trailTime = 0.0;     // snapshot time the trail buffer was last faded to
+        BloomChain bloom;
+    };
+    std::vector<std::unique_ptr<Output>> m_outputs;
+
+    ShaderProgram m_screenShader;
+    GLint m_screenUseTextureLoc;
+    GLint m_screenColorLoc;
+    ShaderProgram m_compositeShader;
+    GLint m_compositeNoiseLoc;
+    GLint m_compositeBloomLoc;
+    GLint m_compositeFlickerLoc;
+    GLint m_compositeDistortionLoc;
+    GLint m_compositeAberrationLoc;
+    GLuint m_frameUbo;
+
+    JobSystem m_jobs;
+    ScenarioFeed m_feed;
+    Simulation m_simulation;
+    SimulationInput m_input;
+
+    // What the simulation hands the renderer for one frame. Two of them are
+    // double-buffered: while the render thread draws one, the simulation
+    // thread steps and records the next into the other.
+    struct FrameSnapshot {
+        DrawList entities;
+        DrawList trails;            // new trail segments, when persistentTrails is set
+        bool persistentTrails = false;
+        bool trailsReset = false;   // trails holds whole trails; clear the buffer first
+        double time = 0.0;          // interpolated simulation time
+        uint32_t liveMissiles = 0;
+        uint32_t explosions = 0;
+        double stepMs = 0.0;        // CPU time spent producing the snapshot
+    };
+    FrameSnapshot m_snapshots[2];
+    int m_readySnapshot;
+
+    // Handshake with the simulation thread: one step request in flight at a time
+    std::thread m_simThread;
+    std::mutex m_simMutex;
+    std::condition_variable m_simWake;
+    std::condition_variable m_simDone;
+    bool m_simPending;
+    bool m_simStopping;
+    double m_simSeconds;            // request: time to advance
+    SimulationInput m_simInput;     // request: input to apply
+    int m_simTarget;                // request: snapshot to fill
+
+    // Game state
+    bool m_running;
+    bool m_fullscreen;
+    bool m_showPerfHud;
+    float m_phosphorHalfLife;
+    CRTMode m_crtMode;
+    bool m_initialized;
+
+    RunStats m_stats;
+
+    // Opens the wall's windows and lays its tiles out over them
+    bool createOutputs();
+    void createSceneTarget(Output& output);
+    void destroySceneTarget(Output& output);
+    // (Re)allocates the output's trail buffer, cleared, at the scene size
+    // and asks the next step for whole trails
+    void createTrailTarget(Output& output);
+    void destroyTrailTarget(Output& output);
+    bool setupPostProcessing();
+    // Builds the screen and composite programs; one that fails to build
+    // keeps the program already loaded
+    bool loadPostShaders();
+    // Relinks every file-based program after an edit
+    void reloadShaders();
+    // Pushes m_view to the renderer and keeps the clamped result
+    void applyView();
+    // Makes the output current: its window, its tile of the view and its
+    // map selection, rescaled if the view changed
+    void selectOutput(size_t index);
+
+    void handleEvents();
+    void handleKey(SDL_Keycode key);
+    // Copies the renderer's culling and glow mode into the snapshot's lists
+    void setupSnapshot(FrameSnapshot& snapshot) const;
+    // Advances the simulation and records the result into snapshot
+    void stepSimulation(FrameSnapshot& snapshot, double seconds, const SimulationInput& input);
+    void startSimulationThread();
+    void stopSimulationThread();
+    void simulationLoop();
+    // Blocks until the step in flight is done and returns its snapshot
+    FrameSnapshot& waitForSnapshot();
+    // Hands the next step to the simulation thread
+    void requestSnapshot(double seconds, const SimulationInput& input);
+
+    void render(FrameSnapshot& snapshot);
+    // Draws the snapshot into the selected output and presents it; only the
+    // primary output is captured, carries the overlay and is GPU-timed
+    void renderOutput(Output& output, FrameSnapshot& snapshot, bool primary);
+    // Fades the output's trail buffer by the snapshot's elapsed time and
+    // adds its new segments
+    void updateTrails(Output& output, FrameSnapshot& snapshot);
+    // Sleeps, then spins, until the deadline; SDL_Delay overshoots by up to a
+    // scheduler quantum
+    void waitUntil(std::chrono::steady_clock::time_point deadline) const;
+};
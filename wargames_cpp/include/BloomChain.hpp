@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Renderer.hpp"
+#include "ShaderProgram.hpp"
+#include <string>
+
+// The downsample and upsample passes of the bloom, built once and shared by
+// every chain, e.g. one per output of a display wall
+class BloomPrograms {
+public:
+    explicit BloomPrograms(Renderer* renderer);
+    ~BloomPrograms();
+    
+    BloomPrograms(const BloomPrograms&) = delete;
+    BloomPrograms& operator=(const BloomPrograms&) = delete;
+    
+    // Builds both passes from shaderDir; if either fails to build, the
+    // loaded ones stay in place and false is returned
+    bool load(const std::string& shaderDir);
+    void destroy();
+    
+    bool isValid() const { return m_downShader.isValid() && m_upShader.isValid(); }
+    
+private:
+    friend class BloomChain;
+    
+    Renderer* m_renderer;
+    ShaderProgram m_downShader;
+    ShaderProgram m_upShader;
+    GLint m_downHalfPixelLoc;
+    GLint m_upHalfPixelLoc;
+};
+
+// Dual-filter bloom. The source is downsampled through half, quarter and
+// eighth resolution targets, then upsampled back to half resolution with a
+// tent filter. Each pass reads only a handful of texels from a smaller
+// target, so the glow is much wider than a full-resolution 9-tap blur at a
+// fraction of its fill cost.
+class BloomChain {
+public:
+    static constexpr int LEVELS = 3;
+    
+    BloomChain(Renderer* renderer, const BloomPrograms* programs);
+    ~BloomChain();
+    
+    BloomChain(const BloomChain&) = delete;
+    BloomChain& operator=(const BloomChain&) = delete;
+    
+    // (Re)allocates the chain targets for a full-resolution source of
+    // width x height
+    void resize(int width, int height);
+    void destroy();
+    
+    // Blurs sourceTexture and returns the half-resolution bloom texture.
+    // Leaves the default framebuffer bound with the full-size viewport.
+    GLuint process(GLuint sourceTexture);
+    
+    bool isValid() const { return m_programs->isValid() && m_levels[0].fbo != 0; }
+    
+private:
+    struct Level {
+        GLuint fbo = 0;
+        GLuint texture = 0;
+        int width = 0;
+        int height = 0;
+    };
+    
+    Renderer* m_renderer;
+    const BloomPrograms* m_programs;
+    Level m_levels[LEVELS];
+    int m_sourceWidth;
+    int m_sourceHeight;
+    
+    void drawPass(const Level& target, GLuint sourceTexture, int sourceWidth, int sourceHeight,
+                  const ShaderProgram& shader, GLint halfPixelLoc);
+};
@@ -5,10 +5,16 @@
 #include <vector>
 #include <memory>
 
-// Screen dimensions
+// Default window size, and the reference screen that line widths and icon
+// sizes are specified against
 constexpr int SCREEN_WIDTH = 1920;
 constexpr int SCREEN_HEIGHT = 1080;
 
+// World space is geographic: x is longitude and y latitude, in degrees. The
+// renderer's projection maps it onto whatever target is being drawn.
+constexpr float WORLD_WIDTH = 360.0f;
+constexpr float WORLD_HEIGHT = 180.0f;
+
 // Colors (R, G, B, A)
 struct Color {
     float r, g, b, a;
@@ -35,6 +41,16 @@ struct Point {
     Point(float x, float y) : x(x), y(y) {}
 };
 
+// Axis-aligned rectangle in world space
+struct Bounds {
+    float minX, minY, maxX, maxY;
+    
+    bool intersects(const Bounds& other) const {
+        return minX <= other.maxX && other.minX <= maxX &&
+               minY <= other.maxY && other.minY <= maxY;
+    }
+};
+
 // Geographic coordinate
 struct LatLon {
     double lat, lon;
@@ -104,10 +120,8 @@ inline const std::array<LatLon, 12> SUBMARINE_POINTS = {{
 }};
 
 // Utility functions
-inline Point lonlat_to_xy(double lon, double lat, int width, int height) {
-    float x = (lon + 180.0f) / 360.0f * width;
-    float y = (90.0f - lat) / 180.0f * height;
-    return Point(x, y);
+inline Point lonlat_to_world(double lon, double lat) {
+    return Point(static_cast<float>(lon), static_cast<float>(lat));
 }
 
 inline float clamp(float value, float min, float max) {
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "Common.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vertex layout for batched line geometry
+struct LineVertex {
+    float x, y;
+    float r, g, b, a;
+    float width;
+    float glow;     // glow layer count for the shader glow path, 0 = plain line
+};
+
+// Per-instance data for the instanced shape meshes
+struct ShapeInstance {
+    float x, y;     // mesh origin in world space
+    float scale;    // mesh scale in reference pixels, the radius for circles
+    float age;      // animation clock: seconds for explosions, progress for pulses
+    float r, g, b, a;
+};
+
+// Per-instance data for trails drawn from the GPU trajectory buffer: the
+// first count points of the path stored at offset
+struct TrailInstance {
+    uint32_t offset;
+    uint32_t count;
+    float r, g, b, a;
+};
+
+// How glowing lines produce their halo: by redrawing the geometry once per
+// layer with glLineWidth, or in one pass with lines expanded to quads and
+// the layer profile evaluated in the fragment shader
+enum class GlowMode {
+    Layered,
+    Shader
+};
+
+// Line meshes uploaded once at startup and drawn by instancing; their
+// vertices are reference-pixel offsets from the instance origin
+enum class ShapeMesh {
+    Circle,         // unit circle
+    SiloIcon,
+    SubmarineIcon,
+    AircraftTag,
+    Count
+};
+
+// Animation evaluated per vertex from ShapeInstance::age; values are
+// shared with the instance vertex shader
+enum class ShapeAnimation {
+    None = 0,
+    ExplosionRings = 1,     // one instance expands into all rings of an explosion
+    ExplosionFlash = 2,
+    TargetPulse = 3         // age is missile progress
+};
+
+// What a view shows, for culling: the on-screen parts of the principal world
+// copy (longitude -180..180), one rectangle per visible copy, and the size
+// of a reference pixel in degrees
+struct ViewCull {
+    static constexpr int MAX_RECTS = 3;
+
+    Bounds rects[MAX_RECTS] = {};
+    int rectCount = 0;
+    float degreesPerPixelX = 0.0f;
+    float degreesPerPixelY = 0.0f;
+
+    // True if bounds, grown by marginPixels reference pixels, is on screen
+    bool isVisible(const Bounds& bounds, float marginPixels = 0.0f) const;
+};
+
+// Geometry recorded on the CPU for one batched draw: line segments bucketed
+// by width, shader-glow segments and mesh instances bucketed by mesh,
+// animation and glow. Building a list touches no GL state, so any thread can
+// fill one while the render thread draws another; Renderer::draw() uploads
+// and empties it.
+class DrawList {
+public:
+    static constexpr int MAX_GLOW_LAYERS = 8;
+
+    struct LineBucket {
+        float width;
+        std::vector<LineVertex> vertices;
+    };
+
+    struct InstanceBucket {
+        ShapeMesh mesh;
+        ShapeAnimation animation;
+        int glowLayers;
+        std::vector<ShapeInstance> instances;
+    };
+
+    struct TrailBucket {
+        int glowLayers;
+        uint32_t maxCount;  // longest trail, which sets the vertex count of the draw
+        std::vector<TrailInstance> trails;
+    };
+
+    // Points to copy into the GPU trajectory buffer before trails are drawn:
+    // count points from start in trailPoints() go to offset in the buffer
+    struct TrailUpload {
+        uint32_t offset;
+        uint32_t start;
+        uint32_t count;
+    };
+
+    // Both are copied from the renderer with Renderer::setupDrawList() before
+    // anything is submitted
+    void setGlowMode(GlowMode mode) { m_glowMode = mode; }
+    GlowMode getGlowMode() const { return m_glowMode; }
+    void setCull(const ViewCull& cull) { m_cull = cull; }
+    const ViewCull& getCull() const { return m_cull; }
+
+    bool isVisible(const Bounds& bounds, float marginPixels = 0.0f) const {
+        return m_cull.isVisible(bounds, marginPixels);
+    }
+
+    void submitLine(float x1, float y1, float x2, float y2, const Color& color, float width = 1.0f, int glowLayers = 0);
+    void submitPath(const Point* points, size_t count, const Color& color, float width = 1.0f, int glowLayers = 0);
+    void submitInstance(ShapeMesh mesh, const ShapeInstance& instance, int glowLayers = 0,
+                        ShapeAnimation animation = ShapeAnimation::None);
+
+    // Records a trail as a reference into the GPU trajectory buffer: the
+    // shader fetches and splits the points, so this costs the same for any
+    // path length. Trails always draw 1 pixel wide.
+    void submitTrail(uint32_t offset, uint32_t count, const Color& color, int glowLayers = 0);
+    // Queues path points for the GPU trajectory buffer at offset
+    void submitTrailPoints(uint32_t offset, const Point* points, size_t count);
+
+    const std::vector<LineBucket>& lineBuckets() const { return m_lineBuckets; }
+    const std::vector<LineVertex>& glowVertices() const { return m_glowVertices; }
+    const std::vector<InstanceBucket>& instanceBuckets() const { return m_instanceBuckets; }
+    const std::vector<TrailBucket>& trailBuckets() const { return m_trailBuckets; }
+    const std::vector<TrailUpload>& trailUploads() const { return m_trailUploads; }
+    const std::vector<Point>& trailPoints() const { return m_trailPoints; }
+
+    size_t lineVertexCount() const;
+    size_t instanceCount() const;
+    size_t trailCount() const;
+    bool empty() const {
+        return lineVertexCount() == 0 && instanceCount() == 0 && trailCount() == 0 && m_trailUploads.empty();
+    }
+
+    // Empties every bucket but keeps the buckets and their storage, so a list
+    // refilled every frame stops allocating once warm
+    void clear();
+    // Drops the queued trajectory points once they are on the GPU, keeping
+    // the rest of the list for another draw
+    void clearTrailUploads();
+
+private:
+    std::vector<LineBucket> m_lineBuckets;
+    std::vector<LineVertex> m_glowVertices;
+    std::vector<InstanceBucket> m_instanceBuckets;
+    std::vector<TrailBucket> m_trailBuckets;
+    std::vector<TrailUpload> m_trailUploads;
+    std::vector<Point> m_trailPoints;
+    GlowMode m_glowMode = GlowMode::Layered;
+    ViewCull m_cull;
+
+    LineBucket& bucketForWidth(float width);
+    InstanceBucket& instanceBucket(ShapeMesh mesh, ShapeAnimation animation, int glowLayers);
+    TrailBucket& trailBucket(int glowLayers);
+    static void appendSegments(std::vector<LineVertex>& vertices, const Point* points, size_t count,
+                               const Color& color, float width, float glow);
+};
@@ -1,14 +1,16 @@
 #pragma once
 
 #include "Common.hpp"
-#include "Renderer.hpp"
+#include "DrawList.hpp"
+#include <vector>
 
 class Explosion {
 public:
     Explosion(float x, float y, const Color& color);
     
     void update(float dt);
-    void draw(Renderer* renderer);
+    // alpha in [0, 1] blends from the previous tick's age to the current one
+    void draw(DrawList& list, float alpha = 1.0f) const;
     
     bool isFinished() const { return m_age >= m_duration; }
     
@@ -16,8 +18,27 @@ private:
     float m_x, m_y;
     Color m_color;
     float m_age;
+    float m_prevAge;
     float m_duration;
+};
+
+// Live explosions stored by value in one array. Finished ones are
+// swap-removed and impacts construct into the freed space, so nothing is
+// allocated until more explosions are alive at once than ever before.
+class ExplosionPool {
+public:
+    static constexpr size_t INITIAL_CAPACITY = 512;
+    
+    explicit ExplosionPool(size_t initialCapacity = INITIAL_CAPACITY);
     
-    static constexpr int NUM_RINGS = 4;
-    static constexpr float RING_DELAYS[NUM_RINGS] = {0.0f, 0.3f, 0.6f, 0.9f};
+    void spawn(float x, float y, const Color& color);
+    // Advances every explosion and drops those that finished
+    void update(float dt);
+    void draw(DrawList& list, float alpha = 1.0f) const;
+    
+    size_t size() const { return m_explosions.size(); }
+    size_t capacity() const { return m_explosions.capacity(); }
+    
+private:
+    std::vector<Explosion> m_explosions;
 };
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records the composited frame without stalling the render loop. Each
+// capture() starts an asynchronous glReadPixels into the next pixel buffer
+// of a small ring and fences it; readbacks the GPU has finished are copied
+// out on later frames and handed to an encoder thread. When the GPU or the
+// encoder falls behind, frames are dropped and counted instead of waited
+// for.
+//
+// Targets:
+//
+//     <file>.y4m         raw YUV 4:2:0 video
+//     pipe:<command>     the same Y4M stream on the command's stdin, e.g.
+//                        "pipe:ffmpeg -i - -c:v libx264 briefing.mp4"
+//     <pattern>.png      one PNG per frame; the pattern holds one %d or
+//                        %0Nd for the frame number, e.g. shots/%05d.png
+class FrameCapture {
+public:
+    static constexpr int RING_SIZE = 3;     // readbacks in flight on the GPU
+    static constexpr int FRAME_POOL = 4;    // frames buffered for the encoder
+
+    struct Stats {
+        uint64_t captured = 0;  // readbacks started
+        uint64_t written = 0;   // frames the encoder finished
+        uint64_t dropped = 0;   // skipped because the GPU or the encoder was behind
+    };
+
+    FrameCapture();
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Frames are width x height; fps only goes into the Y4M header. Needs
+    // the GL context current.
+    bool open(const std::string& target, int width, int height, int fps);
+    // Finishes the readbacks in flight, drains the encoder and closes the
+    // output. Needs the GL context current.
+    void close();
+
+    bool isOpen() const { return m_open; }
+
+    // Reads back the current read framebuffer, whose size is
+    // framebufferWidth x framebufferHeight; frames are skipped while that
+    // differs from the capture size
+    void capture(int framebufferWidth, int framebufferHeight);
+
+    Stats stats() const;
+
+private:
+    enum class Format {
+        Y4M,
+        PngSequence
+    };
+
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+    };
+
+    Format m_format;
+    std::string m_target;
+    FILE* m_file;
+    bool m_pipe;
+    bool m_open;
+    int m_width;
+    int m_height;
+
+    // PNG sequence: the pattern around its frame number, zero-padded to
+    // m_frameDigits (0 for none)
+    std::string m_pathPrefix;
+    std::string m_pathSuffix;
+    int m_frameDigits;
+
+    // Render thread: the readback ring, oldest in flight at m_tail
+    Slot m_slots[RING_SIZE];
+    int m_head;
+    int m_tail;
+    int m_inFlight;
+    bool m_warnedSize;
+
+    // Shared with the encoder: frame buffers in RGBA as read back, plus
+    // FIFO of filled ones waiting to be encoded
+    std::vector<std::vector<uint8_t>> m_frames;
+    std::vector<int> m_freeFrames;
+    int m_queue[FRAME_POOL];
+    int m_queueHead;
+    int m_queueCount;
+    std::mutex m_mutex;
+    std::condition_variable m_frameQueued;
+    std::condition_variable m_frameFreed;
+    bool m_stopping;
+    std::thread m_encoder;
+
+    std::atomic<uint64_t> m_captured;
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
+
+    // Encoder thread only
+    uint64_t m_frameNumber;
+    std::vector<uint8_t> m_encoded;
+    std::vector<uint8_t> m_scanlines;
+    std::string m_path;
+    bool m_failed;
+
+    // Copies finished readbacks out of the ring; with wait set, blocks
+    // until all of them are done and the encoder has room
+    void collect(bool wait);
+    void handOff(Slot& slot, bool wait);
+
+    void encoderLoop();
+    bool writeY4mFrame(const uint8_t* rgba);
+    bool writePng(const uint8_t* rgba);
+};
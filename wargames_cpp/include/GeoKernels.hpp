@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Common.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Batch kernels for the bulk point work of map loading: projecting
+// structure-of-arrays longitude/latitude input into interleaved world-space
+// points, and finding where a run of points jumps across the antimeridian.
+// x86-64 uses SSE2, or AVX where the CPU has it; AArch64 uses NEON; other
+// targets use the scalar code. Every path gives bit-identical results.
+namespace GeoKernels {
+    // out[i] = lonlat_to_world(lon[i], lat[i]); out is the final vertex
+    // layout, so it can point straight into a layer's point array
+    void projectPoints(const double* lon, const double* lat, size_t count, Point* out);
+
+    // Writes every index i in [1, count) where points[i - 1] and points[i]
+    // are more than half the world apart in x, in increasing order, and
+    // returns how many there were. breaks needs room for count - 1 entries.
+    size_t findAntimeridianBreaks(const Point* points, size_t count, uint32_t* breaks);
+
+    // Name of the instruction set the kernels run with, for logs
+    const char* instructionSet();
+}
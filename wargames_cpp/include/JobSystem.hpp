@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads draining a FIFO of jobs. Jobs must not touch
+// GL or SDL state; results go back to the main thread through their own
+// channel (see TrajectoryCache). The FIFO is a ring that only grows, so a
+// job small enough for std::function's inline storage queues without
+// allocating.
+class JobSystem {
+public:
+    // 0 picks one worker per hardware thread, minus one for the render thread
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+    
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    void submit(std::function<void()> job);
+    
+    // Blocks until the queue is empty and no job is running
+    void waitIdle();
+    
+    size_t threadCount() const { return m_workers.size(); }
+    
+private:
+    std::vector<std::thread> m_workers;
+    std::vector<std::function<void()>> m_jobs;   // ring; m_jobCount from m_jobHead
+    size_t m_jobHead = 0;
+    size_t m_jobCount = 0;
+    
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    size_t m_running = 0;
+    bool m_stopping = false;
+    
+    void workerLoop();
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Common.hpp"
+#include "DrawList.hpp"
+#include "TrajectoryCache.hpp"
+#include <cstdint>
+#include <vector>
+
+enum class MissileType : uint8_t {
+    Silo,
+    Submarine
+};
+
+// All live missiles in structure-of-arrays form. Slots are recycled through
+// a free list and each slot references a shared path in the trajectory
+// cache, so spawning and retiring missiles does not touch the allocator once
+// warm and repeated launches between the same sites reuse one path.
+class MissilePool {
+public:
+    static constexpr int PATH_SAMPLES = 220;
+    
+    explicit MissilePool(TrajectoryCache& trajectories, size_t initialCapacity = 64);
+    
+    // Launches at once if the path is cached. Otherwise, when the cache can
+    // take an async request, the path is computed on a worker and the
+    // missile waits in a pending list until activatePending() sees it arrive.
+    void spawn(MissileType type, const LatLon& start, const LatLon& end, const Color& color);
+    
+    // Launches pending missiles whose paths the workers have finished
+    void activatePending();
+    
+    // Advances all missiles by one simulation tick; impact points of those
+    // that finished are appended to impacts and their slots released
+    void update(float dt, std::vector<Point>& impacts);
+    
+    // alpha in [0, 1] blends from the previous tick's state to the current one
+    void draw(DrawList& list, float alpha = 1.0f) const;
+    
+    // Phosphor persistence: icons and target pulses go to list as in draw(),
+    // but trails go to trails and only the part each missile advanced since
+    // the previous call, so a trail costs the same at any length. With
+    // redraw set every visible trail is recorded from its launch site, for
+    // when the persistent buffer was cleared.
+    void drawPersistent(DrawList& list, DrawList& trails, float alpha, bool redraw);
+    
+    // GPU trails: as draw(), but each trail is recorded as its offset into
+    // the trajectory buffer and a point count, with point selection and the
+    // antimeridian split left to the vertex shader. The buffer must mirror
+    // the trajectory arena (DrawList::submitTrailPoints).
+    void drawGpu(DrawList& list, float alpha = 1.0f) const;
+    
+    size_t size() const { return m_live.size(); }
+    size_t capacity() const { return m_progress.size(); }
+    size_t pendingCount() const { return m_pending.size(); }
+    
+private:
+    struct PendingLaunch {
+        MissileType type;
+        LatLon start;
+        LatLon end;
+        Color color;
+    };
+    
+
+    std::vector<float> m_progress;
+    std::vector<float> m_prevProgress;      // progress at the previous tick
+    std::vector<float> m_duration;
+    std::vector<uint32_t> m_trailPoints;    // path points already in the persistent trail
+    std::vector<Color> m_colors;
+    std::vector<MissileType> m_types;
+    std::vector<Point> m_basePos;
+    std::vector<TrajectoryCache::Handle> m_paths;
+    
+    TrajectoryCache& m_trajectories;
+    std::vector<PendingLaunch> m_pending;
+    std::vector<TrajectoryCache::Handle> m_readyPaths;
+    
+    // Dense list of live slots for iteration, plus each slot's index in it
+    std::vector<uint32_t> m_live;
+    std::vector<uint32_t> m_livePos;
+    std::vector<uint32_t> m_freeSlots;
+    
+    void grow(size_t newCapacity);
+    void launch(MissileType type, const LatLon& start, TrajectoryCache::Handle path, const Color& color);
+    void release(uint32_t slot);
+    void drawIcon(DrawList& list, uint32_t slot) const;
+    void drawTrail(DrawList& list, uint32_t slot, int first, int numPoints) const;
+    void drawTargetMarker(DrawList& list, uint32_t slot, float progress) const;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
+#include <string>
+#include <vector>
+
+// On-screen profiler overlay drawn with a vector stroke font, so it needs
+// no textures and matches the rest of the display
+class PerfHud {
+public:
+    explicit PerfHud(Renderer* renderer);
+
+    // Rebuilds the text from a new report; cheap enough to run per window
+    void update(const Profiler::Report& report);
+
+    // Draws into the currently bound target, over whatever is there
+    void draw();
+
+private:
+    Renderer* m_renderer;
+    std::vector<std::string> m_lines;
+
+    // Glyph cell in reference pixels
+    static constexpr float GLYPH_SCALE = 2.0f;
+    static constexpr float ADVANCE = 6.0f * GLYPH_SCALE;
+    static constexpr float LINE_HEIGHT = 10.0f * GLYPH_SCALE;
+
+    void drawText(const std::string& text, float x, float y, const Color& color);
+};
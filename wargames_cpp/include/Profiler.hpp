@@ -0,0 +1,142 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Frame profiler: CPU scoped timers, GPU timer queries and per-frame
+// counters, averaged over a fixed reporting window. GPU results are read
+// back a few frames late and never stall the pipeline.
+class Profiler {
+public:
+    enum class Section {
+        Update,
+        Trails,     // phosphor fade and new trail segments
+        Scene,      // everything drawn into the scene target
+        Map,
+        Entities,
+        Flush,      // batched lines and instances
+        Bloom,
+        Composite,
+        Capture,    // frame readback for FrameCapture
+        Hud,
+        Present,
+        Count
+    };
+
+    enum class Counter {
+        DrawCalls,
+        UploadBytes,
+        LiveMissiles,
+        Explosions,
+        SimulationMs,   // CPU time of the simulation step behind the frame
+        Allocations,    // heap allocations on any thread, when AllocationCounter is enabled
+        Count
+    };
+
+    static constexpr int SECTION_COUNT = static_cast<int>(Section::Count);
+    static constexpr int COUNTER_COUNT = static_cast<int>(Counter::Count);
+
+    static const char* sectionName(Section section);
+    static const char* counterName(Counter counter);
+
+    // Per-frame averages over one window; GPU times only exist for sections
+    // timed with queries
+    struct Report {
+        double seconds = 0.0;           // since the profiler started
+        uint32_t frames = 0;
+        double fps = 0.0;
+        double frameMs = 0.0;
+        double maxFrameMs = 0.0;
+        double cpuMs[SECTION_COUNT] = {};
+        double gpuMs[SECTION_COUNT] = {};
+        bool hasGpu[SECTION_COUNT] = {};
+        double counters[COUNTER_COUNT] = {};
+    };
+
+    explicit Profiler(double reportInterval = 1.0);
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Creates the timer queries; needs a current GL context
+    void initialize();
+    void shutdown();
+
+    void beginFrame();
+    // Returns true when a reporting window closed and report() is new
+    bool endFrame();
+
+    // GPU timing uses GL_TIME_ELAPSED, which cannot nest; a GPU section
+    // begun inside another is timed on the CPU only
+    void beginSection(Section section, bool gpu = false);
+    void endSection(Section section);
+
+    void setCounter(Counter counter, double value);
+
+    const Report& report() const { return m_report; }
+
+    // Appends every report to path: JSON lines for a .json file, CSV
+    // otherwise
+    bool openDump(const std::string& path);
+
+    // Times the enclosing block
+    class Scope {
+    public:
+        Scope(Profiler& profiler, Section section, bool gpu = false)
+            : m_profiler(profiler), m_section(section) {
+            m_profiler.beginSection(section, gpu);
+        }
+        ~Scope() { m_profiler.endSection(m_section); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Profiler& m_profiler;
+        Section m_section;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Queries in flight per section; results are harvested once available
+    static constexpr int QUERY_FRAMES = 4;
+
+    struct SectionState {
+        Clock::time_point start;
+        double frameCpuMs = 0.0;
+        double windowCpuMs = 0.0;
+        double windowGpuMs = 0.0;
+        uint32_t gpuSamples = 0;
+        GLuint queries[QUERY_FRAMES] = {};
+        bool issued[QUERY_FRAMES] = {};
+        bool gpuOpen = false;
+    };
+
+    SectionState m_sections[SECTION_COUNT];
+    double m_frameCounters[COUNTER_COUNT] = {};
+    double m_windowCounters[COUNTER_COUNT] = {};
+
+    double m_reportInterval;
+    Clock::time_point m_startTime;
+    Clock::time_point m_windowStart;
+    Clock::time_point m_frameStart;
+    uint32_t m_frameIndex;
+    uint32_t m_windowFrames;
+    double m_windowFrameMs;
+    double m_windowMaxFrameMs;
+    bool m_gpuBusy;
+    bool m_initialized;
+
+    Report m_report;
+
+    std::ofstream m_dump;
+    bool m_dumpJson;
+
+    void harvestQueries();
+    void writeDump();
+};
@@ -1,22 +1,145 @@
 #pragma once
 
 #include "Common.hpp"
+#include "DrawList.hpp"
+#include "ShaderProgram.hpp"
+#include "ShaderCache.hpp"
 #include <SDL2/SDL.h>
 #include <glad/gl.h>
 #include <string>
+#include <vector>
+
+// Visible region of the world: the longitude and latitude at the center of
+// the target and a magnification, where zoom 1 shows the whole globe
+struct MapView {
+    float centerLon = 0.0f;
+    float centerLat = 0.0f;
+    float zoom = 1.0f;
+};
+
+// Part of the view one output shows, as fractions of the view's width and
+// height from its top-left corner. A display wall gives each screen a tile;
+// the default is the whole view.
+struct ViewTile {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+};
+
+// Immutable line strips resident on the GPU, uploaded once
+struct StaticLineBuffer {
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLsizei vertexCount = 0;
+};
+
+// How the window and its GL context are created
+struct WindowSettings {
+    bool vsync = true;
+    bool hidden = false;    // offscreen runs: the window exists for its context but is never shown
+    std::string shaderCacheDir;     // program binaries kept between runs; empty compiles every start
+};
+
+// GPU work issued through the renderer since the last resetFrameStats()
+struct FrameStats {
+    uint32_t drawCalls = 0;
+    uint64_t uploadBytes = 0;
+};
 
 class Renderer {
 public:
+    // Glow technique, meshes and animations shared with DrawList
+    using GlowMode = ::GlowMode;
+    using Mesh = ShapeMesh;
+    using MeshAnimation = ShapeAnimation;
+    
     Renderer(int width, int height);
     ~Renderer();
     
-    bool initialize();
+    bool initialize(const WindowSettings& settings = WindowSettings{});
     void shutdown();
     
+    // Window drawable size changed; the default framebuffer viewport follows
+    void resize(int width, int height);
+    
+    // Pixel size of the target being drawn into. Geometry is in world space
+    // and line widths and icon sizes are in reference pixels of a
+    // SCREEN_WIDTH x SCREEN_HEIGHT screen, scaled by height / SCREEN_HEIGHT,
+    // so the picture looks the same at any resolution.
+    void setViewport(int width, int height);
+    float getPixelScale() const { return m_pixelScale; }
+    
+    // True if vsync was requested and the driver accepted the swap interval,
+    // so present() paces the frame
+    bool isVsyncActive() const { return m_vsyncActive; }
+    
+    // View transform applied in the vertex shaders. Geometry is drawn once
+    // per visible copy of the world, so any central meridian wraps cleanly.
+    // Changing the view only updates uniforms.
+    void setView(const MapView& view);
+    const MapView& getView() const { return m_view; }
+    
+    // Narrows drawing to one tile of the view. Visible rects and culling
+    // follow the tile; lists set up by setupDrawList() are culled against
+    // the whole view, so one list serves every tile.
+    void setViewTile(const ViewTile& tile);
+    const ViewTile& getViewTile() const { return m_tile; }
+    
+    // On-screen parts of the principal world copy (longitude -180..180),
+    // one rectangle per visible copy; used for culling
+    static constexpr int MAX_VISIBLE_RECTS = ViewCull::MAX_RECTS;
+    int getVisibleRects(const Bounds*& rects) const;
+    const ViewCull& getCull() const { return m_cull; }
+    
+    // True if bounds, grown by marginPixels reference pixels, is on screen
+    bool isVisible(const Bounds& bounds, float marginPixels = 0.0f) const {
+        return m_cull.isVisible(bounds, marginPixels);
+    }
+    
+    // Screen-space overlay: between these calls submitted geometry is in
+    // reference pixels from the top-left corner of the target instead of
+    // world space, drawn once without wrapping
+    void beginOverlay();
+    void endOverlay();
+    
+    const FrameStats& getFrameStats() const { return m_stats; }
+    void resetFrameStats() { m_stats = FrameStats{}; }
+    
     // Basic drawing
     void clear(const Color& color = Colors::BLACK);
     void present();
     
+    // Frame-wide line batching. Between beginBatch() and flushBatch() all
+    // draw* calls are accumulated and drawn in one call per line width.
+    // Outside a batch every draw* call is flushed immediately.
+    void beginBatch();
+    void submitLine(float x1, float y1, float x2, float y2, const Color& color, float width = 1.0f, int glowLayers = 0);
+    void submitPath(const Point* points, size_t count, const Color& color, float width = 1.0f, int glowLayers = 0);
+    void flushBatch();
+    
+    // Lists recorded away from the renderer, e.g. on the simulation thread.
+    // setupDrawList() copies the current glow mode and view culling into an
+    // empty list; draw() uploads and draws the list under the current view
+    // and empties it. drawRetained() leaves the list intact so it can be
+    // drawn again under another tile; its trajectory points go up once.
+    void setupDrawList(DrawList& list) const;
+    void draw(DrawList& list);
+    void drawRetained(DrawList& list);
+    
+    // Lists may carry trails that reference the GPU trajectory buffer
+    // (DrawList::submitTrail); without the trail programs they are skipped
+    bool supportsGpuTrails() const { return m_trailShader.isValid(); }
+    
+    // Queues one instance of a mesh. Instances sharing mesh, animation and
+    // glow are drawn together with a single instanced call per glow pass.
+    void submitInstance(Mesh mesh, const ShapeInstance& instance, int glowLayers = 0,
+                        MeshAnimation animation = MeshAnimation::None);
+    
+    // Glow technique used by every *WithGlow call
+    void setGlowMode(GlowMode mode);
+    GlowMode getGlowMode() const { return m_glowMode; }
+    
     // Line drawing with glow
     void drawLine(float x1, float y1, float x2, float y2, const Color& color, float width = 1.0f);
     void drawLineWithGlow(float x1, float y1, float x2, float y2, const Color& color, int layers = 5);
@@ -29,17 +152,42 @@ public:
     void drawPath(const std::vector<Point>& points, const Color& color, float width = 1.0f);
     void drawPathWithGlow(const std::vector<Point>& points, const Color& color, int layers = 5);
     
+    // Static geometry: strips are addressed by (first, count) ranges into the
+    // buffer and drawn with a single glMultiDrawArrays per layer
+    bool createStaticLines(StaticLineBuffer& out, const std::vector<Point>& points);
+    bool createStaticLines(StaticLineBuffer& out, const Point* points, size_t count);
+    void drawStaticLines(const StaticLineBuffer& buffer, const GLint* firsts, const GLsizei* counts,
+                         GLsizei drawCount, const Color& color, float width = 1.0f);
+    void drawStaticLinesWithGlow(const StaticLineBuffer& buffer, const GLint* firsts, const GLsizei* counts,
+                                 GLsizei drawCount, const Color& color, int layers = 5);
+    void destroyStaticLines(StaticLineBuffer& buffer);
+    
     // Shader management
+    // Programs come from the binary cache when it holds them
     GLuint loadShader(const std::string& vertexPath, const std::string& fragmentPath);
+    const ShaderCache& getShaderCache() const { return m_shaderCache; }
     void useShader(GLuint program);
     void renderFullscreenQuad();
     
     // Framebuffer management
-    GLuint createFramebuffer(int width, int height, GLuint& textureOut);
+    // internalFormat is GL_RGBA or a float format such as GL_RGBA16F
+    GLuint createFramebuffer(int width, int height, GLuint& textureOut, GLenum internalFormat = GL_RGBA);
     void bindFramebuffer(GLuint fbo);
+    void bindFramebuffer(GLuint fbo, int width, int height);
+    // Returns to the window with its full-size viewport
     void unbindFramebuffer();
     
-    // Accessors
+    // Further windows sharing the renderer's GL context, e.g. one per
+    // display of a wall. Everything the renderer manages is usable in all of
+    // them; only swaps of the primary window wait for vsync.
+    SDL_Window* createWindow(const char* title, const SDL_Rect& bounds, bool fullscreen, bool hidden);
+    void destroyWindow(SDL_Window* window);
+    // Makes window, whose drawable is width x height, the target of
+    // unbindFramebuffer() and present()
+    void selectWindow(SDL_Window* window, int width, int height);
+    
+    // Accessors; width and height are the selected window's drawable size,
+    // getWindow() is the primary window
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
     SDL_Window* getWindow() { return m_window; }
@@ -51,11 +199,76 @@ private:
     int m_width;
     int m_height;
     SDL_Window* m_window;
+    SDL_Window* m_currentWindow;
     SDL_GLContext m_glContext;
+    bool m_vsyncActive;
+    int m_swapInterval;     // last interval set on the context
+    
+    struct MeshRange {
+        GLint first;
+        GLsizei count;
+    };
+    
+    struct ProgramUniforms {
+        GLint animation = -1;
+        GLint style = -1;
+        GLint alphaScale = -1;
+        GLint viewport = -1;
+        GLint pixelScale = -1;
+        GLint pixelToClip = -1;
+        GLint projection = -1;
+        GLint wrapOffset = -1;
+    };
     
     GLuint m_vao;
     GLuint m_vbo;
-    GLuint m_basicShader;
+    size_t m_vboCapacity;
+    size_t m_vboOffset;
+    ShaderCache m_shaderCache;
+    DrawList m_batch;       // geometry submitted through the renderer itself
+    bool m_batching;
+    GlowMode m_glowMode;
+    ShaderProgram m_basicShader;
+    ShaderProgram m_glowShader;
+    
+    GLuint m_meshVao;
+    GLuint m_meshVbo;
+    GLuint m_instanceVbo;
+    size_t m_instanceCapacity;
+    MeshRange m_meshes[static_cast<size_t>(Mesh::Count)];
+    ShaderProgram m_instanceShader;
+    ShaderProgram m_instanceGlowShader;
+    ProgramUniforms m_basicUniforms;
+    ProgramUniforms m_glowUniforms;
+    ProgramUniforms m_instanceUniforms;
+    ProgramUniforms m_instanceGlowUniforms;
+    
+    // Trails drawn from a GPU mirror of the trajectory arena, read as a
+    // buffer texture; only the per-trail instances are uploaded each frame
+    GLuint m_trailVao;
+    GLuint m_trailInstanceVbo;
+    size_t m_trailInstanceCapacity;
+    GLuint m_trailPointBuffer;
+    GLuint m_trailPointTexture;
+    size_t m_trailPointCapacity;    // in points
+    size_t m_trailPointLimit;       // GL_MAX_TEXTURE_BUFFER_SIZE
+    bool m_warnedTrailLimit;
+    ShaderProgram m_trailShader;
+    ShaderProgram m_trailGlowShader;
+    ProgramUniforms m_trailUniforms;
+    ProgramUniforms m_trailGlowUniforms;
+    
+    int m_viewportWidth;
+    int m_viewportHeight;
+    float m_pixelScale;
+    
+    MapView m_view;
+    ViewTile m_tile;
+    int m_wrapFirst;    // first visible world copy, in units of WORLD_WIDTH
+    int m_wrapCount;
+    ViewCull m_cull;
+    ViewCull m_viewCull;    // the whole view, for setupDrawList()
+    FrameStats m_stats;
     GLuint m_quadVao;
     GLuint m_quadVbo;
     GLuint m_quadEbo;
@@ -64,5 +277,31 @@ private:
     
     void setupGL();
     void setupScreenQuad();
+    void setupMeshes();
+    void setupTrails();
+    void reserveTrailPoints(size_t points);
+    void cacheUniforms(const ShaderProgram& program, ProgramUniforms& uniforms);
+    void setProjection(const float* matrix);
+    
+    // Issues draw() once per visible world copy with the program's wrap offset set
+    template <typename DrawFn>
+    void drawWrapped(const ProgramUniforms& uniforms, DrawFn draw);
+    static constexpr int CIRCLE_SEGMENTS = 32;
+    
+    void updateCullScale();
+    // Fills cull.rects with the parts of the lon/lat window in the principal copy
+    static void setCullRects(ViewCull& cull, float left, float right, float bottom, float top);
+    void drawBatch();
+    void drawLines(const DrawList& list);
+    void drawInstances(const DrawList& list);
+    void drawInstanceBucket(const DrawList::InstanceBucket& bucket, size_t byteOffset);
+    void uploadTrailPoints(const DrawList& list);
+    void drawTrails(const DrawList& list);
+    void drawTrailBucket(const DrawList::TrailBucket& bucket, size_t byteOffset);
+    void drawStaticLinesStyled(const StaticLineBuffer& buffer, const GLint* firsts, const GLsizei* counts,
+                               GLsizei drawCount, const Color& color, float width, int glowLayers);
+    static void buildCircle(float x, float y, float radius, Point* points);
+    GLuint compileShader(GLenum type, const char* source);
+    GLuint buildProgram(const char* vertexSource, const char* geometrySource, const char* fragmentSource);
     std::string loadShaderSource(const std::string& path);
 };
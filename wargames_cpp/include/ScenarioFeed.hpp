@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Common.hpp"
+#include "LockFreeQueue.hpp"
+#include "MissilePool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One launch taken from an external feed
+struct LaunchEvent {
+    double time = 0.0;      // replay seconds after the first record; 0 for live sources
+    MissileType type = MissileType::Silo;
+    LatLon start;
+    LatLon end;
+};
+
+// Launch records streamed in from outside: a UDP port, a named pipe, or a
+// file replayed on its own timestamps. A reader thread owns the source and
+// parses records into a bounded lock-free queue with fixed buffers, so a
+// feed of thousands of records per second costs the simulation one pop per
+// launch and never allocates.
+//
+// Records are text, one per line; blank lines and lines starting with '#'
+// are skipped:
+//
+//     <seconds> <S|U> <start lat> <start lon> <target lat> <target lon>
+//
+// S is a silo launch and U a submarine launch. A UDP datagram may carry
+// several lines. Live sources (UDP and pipes) launch on arrival and ignore
+// the timestamp; a file replays each record at its timestamp, relative to
+// the first, divided by the replay speed.
+class ScenarioFeed {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 16384;
+
+    struct Stats {
+        uint64_t parsed = 0;
+        uint64_t rejected = 0;  // malformed or out-of-range records
+        uint64_t dropped = 0;   // live records that arrived while the queue was full
+    };
+
+    ScenarioFeed();
+    ~ScenarioFeed();
+
+    ScenarioFeed(const ScenarioFeed&) = delete;
+    ScenarioFeed& operator=(const ScenarioFeed&) = delete;
+
+    // source is "udp:<port>" or the path of a file or named pipe
+    bool open(const std::string& source, double replaySpeed = 1.0);
+    void close();
+
+    bool isOpen() const { return m_thread.joinable(); }
+    bool isLive() const { return m_live; }
+    // The source is exhausted and every record has been polled
+    bool finished() const;
+
+    // Appends up to maxEvents launches due at or before time (seconds since
+    // the feed started being polled) to out. Called from one thread only.
+    size_t poll(double time, std::vector<LaunchEvent>& out, size_t maxEvents);
+
+    Stats stats() const;
+
+    // Parses one record without its line terminator; false if it is
+    // malformed or a coordinate is out of range
+    static bool parseRecord(const char* line, size_t length, LaunchEvent& out);
+
+private:
+    LockFreeQueue<LaunchEvent> m_queue;
+    std::thread m_thread;
+    int m_fd;
+    bool m_live;
+    bool m_datagram;
+    double m_replaySpeed;
+
+    std::atomic<bool> m_stopping;
+    std::atomic<bool> m_sourceDone;
+    std::atomic<uint64_t> m_parsed;
+    std::atomic<uint64_t> m_rejected;
+    std::atomic<uint64_t> m_dropped;
+
+    // Consumer side: the next replayed record, popped but not yet due
+    LaunchEvent m_held;
+    bool m_hasHeld;
+
+    // Reader side
+    bool m_haveOrigin;
+    double m_timeOrigin;
+
+    void readerLoop();
+    // Parses every complete line in data and returns the bytes consumed;
+    // with final set, a trailing unterminated line counts as complete
+    size_t parseLines(const char* data, size_t length, bool final);
+    void publish(LaunchEvent& event);
+};
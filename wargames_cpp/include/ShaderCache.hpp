@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstdint>
+#include <string>
+
+// Linked program binaries kept on disk between runs, so a warm start skips
+// compiling and linking. An entry is keyed by a hash of the stage sources
+// and the driver's vendor, renderer and version strings: an edited shader
+// or a driver update simply misses. A binary the driver still rejects is
+// rebuilt from source and its entry rewritten.
+class ShaderCache {
+public:
+    ShaderCache();
+
+    // Needs the GL context. An empty directory, or a driver without program
+    // binary support, leaves the cache disabled.
+    void initialize(const std::string& directory);
+
+    bool isEnabled() const { return m_enabled; }
+
+    // geometry may be null
+    uint64_t key(const char* vertex, const char* geometry, const char* fragment) const;
+
+    // A newly created, linked program from the entry for key, or 0 on a miss
+    GLuint load(uint64_t key);
+    // Writes the binary of program, which must have been linked with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+    void store(uint64_t key, GLuint program);
+
+    uint32_t hits() const { return m_hits; }
+    uint32_t misses() const { return m_misses; }
+
+private:
+    std::string m_directory;
+    std::string m_driver;
+    bool m_enabled;
+    uint32_t m_hits;
+    uint32_t m_misses;
+
+    std::string pathFor(uint64_t key) const;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <string>
+#include <unordered_map>
+
+// Owns a linked GL program and resolves every active uniform once at link
+// time, so per-frame code only deals in cached integer locations
+class ShaderProgram {
+public:
+    ShaderProgram() = default;
+    explicit ShaderProgram(GLuint program);
+    ~ShaderProgram();
+    
+    ShaderProgram(ShaderProgram&& other) noexcept;
+    ShaderProgram& operator=(ShaderProgram&& other) noexcept;
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+    
+    bool isValid() const { return m_program != 0; }
+    GLuint id() const { return m_program; }
+    void use() const { glUseProgram(m_program); }
+    
+    // Cached location, -1 when the program has no such active uniform.
+    // Intended for setup code; keep the result rather than calling per frame.
+    GLint uniform(const std::string& name) const;
+    
+    // Attaches a std140 uniform block to a binding point, if the program uses it
+    void bindUniformBlock(const char* name, GLuint binding) const;
+    
+    // Deletes the program; must run while its GL context is still current
+    void destroy();
+    
+private:
+    GLuint m_program = 0;
+    std::unordered_map<std::string, GLint> m_uniforms;
+    
+    void cacheUniforms();
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+// Development aid: notices edits to the shader sources in one directory by
+// polling their modification times, so changed programs can be relinked
+// while the application runs. A poll is a handful of stat calls.
+class ShaderWatcher {
+public:
+    // Records the current state of directory; later polls report changes
+    // against it
+    void watch(const std::string& directory);
+
+    // True when a .vert, .geom or .frag file was added, removed or modified
+    // since the previous call
+    bool poll();
+
+private:
+    using FileTimes = std::unordered_map<std::string, std::filesystem::file_time_type>;
+
+    std::string m_directory;
+    FileTimes m_times;
+
+    FileTimes scan() const;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Common.hpp"
+#include "DrawList.hpp"
+#include "TrajectoryCache.hpp"
+#include "MissilePool.hpp"
+#include "Explosion.hpp"
+#include "Aircraft.hpp"
+#include "ScenarioFeed.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class JobSystem;
+
+struct SimulationConfig {
+    uint32_t seed = 0;
+    int tickHz = 60;
+    float launchInterval = 2.0f;    // seconds between single launches
+    float burstInterval = 0.0f;     // seconds between automatic bursts; 0 = on request only
+    int initialMissiles = 0;
+    int aircraftCount = 12;
+};
+
+// Player input gathered on the window thread and applied at the start of the
+// next step
+struct SimulationInput {
+    float launchInterval = 2.0f;
+    int bursts = 0;
+    bool persistentTrails = false;  // record trails incrementally for a phosphor buffer
+    bool redrawTrails = false;      // the phosphor buffer was cleared; record whole trails once
+    bool gpuTrails = false;         // record trails as references into the GPU trajectory buffer
+};
+
+// Missiles, aircraft and explosions. Everything here is plain CPU work with
+// no GL or SDL state, so it can run on its own thread and hand each frame
+// to the renderer as a DrawList. Time advances in fixed ticks; the remainder
+// of a step is kept and used to interpolate between the last two ticks.
+class Simulation {
+public:
+    Simulation(const SimulationConfig& config, JobSystem* jobs);
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Prewarms the trajectory cache and populates the scenario
+    void initialize();
+
+    // Launches come from feed, polled every tick, instead of the random
+    // launch timer; bursts still work. The feed must outlive the simulation.
+    void attachFeed(ScenarioFeed* feed);
+
+    // Adds seconds to the accumulator and runs every whole tick it holds, at
+    // most MAX_TICKS_PER_STEP; returns the number of ticks run
+    int step(double seconds, const SimulationInput& input);
+
+    // Records every visible entity between the last two ticks into list,
+    // culled against the list's view. With trails given, missile trails go
+    // there instead, each only as far as it advanced since the last call
+    // (see MissilePool::drawPersistent). Otherwise, with gpuTrails set,
+    // trails are recorded for the GPU trajectory buffer and the list also
+    // carries the arena points written since the previous such call, so
+    // every list built this way must reach the renderer, in order.
+    void buildDrawList(DrawList& list, DrawList* trails = nullptr, bool redrawTrails = false,
+                       bool gpuTrails = false);
+
+    // Fraction of a tick past the last one, and the matching time
+    float alpha() const { return static_cast<float>(m_accumulator / m_tickSeconds); }
+    double interpolatedTime() const { return m_time + m_accumulator - m_tickSeconds; }
+
+    size_t liveMissiles() const { return m_missiles.size(); }
+    size_t explosionCount() const { return m_explosions.size(); }
+    uint64_t missilesLaunched() const { return m_missilesLaunched; }
+
+    static constexpr int MAX_TICKS_PER_STEP = 5;
+    // Feed launches spawned per tick at most; the rest wait in the feed
+    static constexpr size_t MAX_FEED_LAUNCHES_PER_TICK = 4096;
+    // Missile slots and uncached trajectories reserved up front, so a run
+    // below that many in flight never grows either
+    static constexpr size_t MISSILE_CAPACITY = 1024;
+
+private:
+    SimulationConfig m_config;
+    std::mt19937 m_rng;
+
+    TrajectoryCache m_trajectories;
+    MissilePool m_missiles;
+    std::vector<Aircraft> m_aircraft;
+    std::vector<Point> m_aircraftLoops;     // path storage shared by every aircraft
+    ExplosionPool m_explosions;
+    std::vector<Point> m_impacts;
+    ScenarioFeed* m_feed;
+    std::vector<LaunchEvent> m_feedEvents;
+    double m_feedTime;
+    bool m_gpuTrailsSynced;     // the renderer's trajectory buffer mirrors the arena
+
+    double m_tickSeconds;
+    double m_accumulator;
+    double m_time;
+    float m_launchInterval;
+    float m_timeSinceLastLaunch;
+    float m_timeSinceLastBurst;
+    uint64_t m_missilesLaunched;
+
+    // Random utility functions
+    int randomInt(int min, int max);
+    float randomFloat(float min, float max);
+    LatLon randomTarget();
+    LatLon randomSubmarineStart();
+    LatLon randomWesternTarget();
+    LatLon randomEasternTarget();
+
+    void launchRandom();
+    void launchBurst();
+    void tick(float dt);
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Common.hpp"
+#include "LockFreeQueue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// Projected geodesic paths keyed by (start, end, samples). Every path is
+// computed once, stored in a shared arena and handed out by handle with a
+// reference count. Unreferenced paths stay cached until their arena block
+// is needed for a new path of the same length; pinned paths never expire.
+//
+// With a job system attached, misses can be computed on worker threads
+// instead: requestAsync() hands the geodesic to a worker along with one of a
+// fixed set of result buffers, the worker publishes the buffer through a
+// lock-free queue and collectCompleted() copies it into the arena on the
+// owning thread. Only that thread touches the arena; in the application it
+// is the simulation thread. Lookup, reclaim lists and result buffers are all
+// preallocated storage, so once reserve() has covered the peak a miss does
+// not touch the allocator.
+class TrajectoryCache {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle INVALID_HANDLE = 0xFFFFFFFFu;
+    
+    explicit TrajectoryCache(JobSystem* jobs = nullptr);
+    ~TrajectoryCache();
+    
+    TrajectoryCache(const TrajectoryCache&) = delete;
+    TrajectoryCache& operator=(const TrajectoryCache&) = delete;
+    
+    // Returns a referenced path, computing it on a miss
+    Handle acquire(const LatLon& start, const LatLon& end, int samples);
+    // Returns a referenced path if it is cached, INVALID_HANDLE otherwise
+    Handle tryAcquire(const LatLon& start, const LatLon& end, int samples);
+    void release(Handle handle);
+    
+    bool isAsync() const { return m_jobs != nullptr; }
+    
+    // Queues the path on the job system unless it is cached or in flight.
+    // Returns false when it cannot be queued, either without a job system or
+    // with every result buffer in flight; acquire() it instead.
+    bool requestAsync(const LatLon& start, const LatLon& end, int samples);
+    
+    // Inserts paths finished by the workers. Each handle appended to ready
+    // holds one reference that the caller must release.
+    size_t collectCompleted(std::vector<Handle>& ready);
+    size_t inFlight() const { return m_slots.size() - m_freeSlots.size(); }
+    
+    // Sizes the arena, lookup and result buffers for paths entries of the
+    // given sample count, so reaching that many does not allocate
+    void reserve(size_t paths, int samples);
+    
+    // Computes and pins every (start, end) combination of the two tables
+    void prewarm(const LatLon* starts, size_t startCount, const LatLon* ends, size_t endCount, int samples);
+    
+    static constexpr uint32_t MAX_BREAKS = 4;
+    
+    const Point* points(Handle handle) const { return &m_arena[m_entries[handle].offset]; }
+    uint32_t count(Handle handle) const { return m_entries[handle].count; }
+    
+    // Indices where the projected path wraps across the antimeridian; each
+    // one starts a new drawable run, so a prefix of the path splits into
+    // index ranges without copying
+    const uint32_t* breaks(Handle handle) const { return m_entries[handle].breaks; }
+    uint32_t breakCount(Handle handle) const { return m_entries[handle].breakCount; }
+    
+    // World-space box around the whole path, for view culling
+    const Bounds& bounds(Handle handle) const { return m_entries[handle].bounds; }
+    
+    size_t entryCount() const { return m_entries.size(); }
+    size_t arenaSize() const { return m_arena.size(); }
+    
+    // Arena offset of the path's first point; a GPU mirror of the whole
+    // arena addresses paths by it
+    uint32_t offset(Handle handle) const { return m_entries[handle].offset; }
+    const Point* arenaData() const { return m_arena.data(); }
+    
+    // Span of the arena [begin, end) written since the last clearWritten(),
+    // by a computed, collected or recycled path; empty when begin == end.
+    // Keeping a mirror current means uploading just this span.
+    uint32_t writtenBegin() const { return m_writtenBegin < m_writtenEnd ? m_writtenBegin : 0; }
+    uint32_t writtenEnd() const { return m_writtenBegin < m_writtenEnd ? m_writtenEnd : 0; }
+    void clearWritten();
+    // Marks the whole arena written, for a mirror that starts from nothing
+    void markAllWritten();
+    
+    // Samples the WGS84 geodesic from start to end into out[0..samples)
+    static void calculatePath(const LatLon& start, const LatLon& end, int samples, Point* out);
+    
+private:
+    struct Key {
+        double startLat, startLon;
+        double endLat, endLon;
+        int samples;
+        
+        bool operator==(const Key& other) const {
+            return startLat == other.startLat && startLon == other.startLon &&
+                   endLat == other.endLat && endLon == other.endLon &&
+                   samples == other.samples;
+        }
+    };
+    
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    
+    // Result buffer for one async request; a worker owns it from submit
+    // until collectCompleted() pops its index
+    struct AsyncSlot {
+        Key key;
+        std::vector<Point> points;
+    };
+    
+    struct Entry {
+        Key key;
+        uint32_t offset;
+        uint32_t count;
+        uint32_t refs;
+        uint32_t breaks[MAX_BREAKS];
+        uint32_t breakCount;
+        Bounds bounds;
+        bool pinned;
+        bool reclaimable;   // queued in m_reclaim for its length
+        bool pending;       // keyed but not computed yet; a worker has it
+        Handle nextReclaim;
+    };
+    
+    // Unreferenced entries of one path length, oldest first, linked
+    // through Entry::nextReclaim
+    struct ReclaimList {
+        uint32_t count;
+        Handle head;
+        Handle tail;
+    };
+    
+    std::vector<Point> m_arena;
+    std::vector<Entry> m_entries;
+    
+    // Open-addressed handles by key, linear probing, at most half full.
+    // Every entry is in it, so the entry count is the load.
+    std::vector<Handle> m_table;
+    
+    std::vector<ReclaimList> m_reclaim;
+    
+    JobSystem* m_jobs;
+    std::vector<AsyncSlot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    LockFreeQueue<uint32_t> m_completed;   // indices into m_slots
+    std::atomic<bool> m_shuttingDown{false};
+    
+    uint32_t m_writtenBegin = 0xFFFFFFFFu;
+    uint32_t m_writtenEnd = 0;
+    
+    static Key makeKey(const LatLon& start, const LatLon& end, int samples);
+    Handle find(const Key& key) const;
+    void insert(Handle handle);
+    void erase(const Key& key);
+    void rehash(size_t tableSize);
+    ReclaimList& reclaimList(uint32_t count);
+    // Keys a block for key, recycling the oldest unreferenced one of the
+    // same length if there is one, and inserts it into the lookup
+    Handle allocate(const Key& key);
+    void computePath(Entry& entry);
+    void analyzePath(Entry& entry) const;
+    void noteWritten(const Entry& entry);
+};
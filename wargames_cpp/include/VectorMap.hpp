@@ -13,19 +13,96 @@ public:
     bool loadShapefiles(const std::string& coastlinePath, const std::string& countriesPath);
     void draw();
     
+    // Screen pixels per degree of longitude; drives the level-of-detail choice
+    void setViewScale(float pixelsPerUnit);
+    
+    // Visible parts of the principal world copy (see Renderer::getVisibleRects);
+    // segments outside all of them are skipped
+    void setVisibleRects(const Bounds* rects, int count);
+    
+    // The map keeps the drawn segments of several views, so outputs showing
+    // different tiles each keep theirs from frame to frame. The view
+    // setters and draw() apply to the active view; new views start on the
+    // whole world.
+    void setViewCount(int count);
+    void setActiveView(int index);
+    
 private:
-    struct LineSegment {
+    // The micro-benchmarks drive the individual load stages directly
+    friend class VectorMapBench;
+    
+    // Douglas-Peucker tolerances (degrees) of each level, finest first. At
+    // the reference 1920 px width these are 0.35, 1 and 3 pixels.
+    static constexpr int LOD_LEVELS = 4;
+    static constexpr float LOD_TOLERANCES[LOD_LEVELS] = {0.0f, 0.065625f, 0.1875f, 0.5625f};
+    
+    // Uniform grid over the world used to find the segments in view
+    static constexpr int GRID_COLUMNS = 36;
+    static constexpr int GRID_ROWS = 18;
+    
+    // All segments of a layer, at every level of detail, share one point
+    // array; each segment is a (first, count) range into it per level,
+    // ready for glMultiDrawArrays
+    struct MapLayer {
         std::vector<Point> points;
+        std::vector<GLint> firsts[LOD_LEVELS];
+        std::vector<GLsizei> counts[LOD_LEVELS];
+        std::vector<Bounds> bounds;
+        
+        // Segment indices per grid cell, as ranges of cellSegments; a
+        // segment is listed in every cell its bounds overlap
+        std::vector<uint32_t> cellStarts;
+        std::vector<uint32_t> cellSegments;
+        std::vector<uint32_t> visited;
+        uint32_t visitStamp = 0;
+        
+        // Ranges actually drawn, per view, rebuilt when that view changes
+        struct DrawRanges {
+            std::vector<GLint> firsts;
+            std::vector<GLsizei> counts;
+        };
+        std::vector<DrawRanges> drawn;
+        
         Color color;
+        StaticLineBuffer gpu;
     };
     
     Renderer* m_renderer;
-    std::vector<LineSegment> m_coastlines;
-    std::vector<LineSegment> m_borders;
-    std::vector<LineSegment> m_russiaBorders;
+    MapLayer m_coastlines;
+    MapLayer m_borders;
+    MapLayer m_russiaBorders;
+    
+    // What one view's ranges were selected for
+    struct ViewState {
+        float viewScale;
+        Bounds visibleRects[Renderer::MAX_VISIBLE_RECTS];
+        int visibleRectCount;
+    };
+    std::vector<ViewState> m_views;
+    size_t m_activeView;
+    std::vector<uint32_t> m_splitBreaks;    // scratch for splitAtAntimeridian
+    
+    // Binary cache of the fully processed layers, stored next to the
+    // shapefiles and invalidated when any source file changes
+    static std::string cachePathFor(const std::string& coastlinePath);
+    bool loadCache(const std::string& cachePath, const std::vector<std::string>& sources);
+    bool writeCache(const std::string& cachePath, const std::vector<std::string>& sources) const;
     
     bool loadCoastlines(const std::string& path);
     bool loadCountries(const std::string& path);
-    void splitAtAntimeridian(const std::vector<Point>& points, std::vector<LineSegment>& output, const Color& color);
-    bool crossesAntimeridian(const Point& p1, const Point& p2);
+    // Projects one shapefile part onto the end of output and splits it
+    void appendPart(const double* lon, const double* lat, size_t count, MapLayer& output);
+    // Cuts the points of output from first on into strips at antimeridian
+    // jumps, recording each strip as a level 0 range
+    void splitAtAntimeridian(MapLayer& output, size_t first);
+    void clearLayer(MapLayer& layer);
+    void buildLevelsOfDetail(MapLayer& layer);
+    void buildSpatialIndex(MapLayer& layer);
+    // Reselects every layer for the active view
+    void selectAll();
+    // Reselects layer for every view
+    void selectLevelsOfDetail(MapLayer& layer);
+    void selectRanges(MapLayer& layer, size_t view);
+    void uploadLayer(MapLayer& layer);
+    void drawLayer(const MapLayer& layer);
 };
@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+uniform sampler2D screenTexture;
+uniform vec2 halfPixel; // half a texel of the source level
+
+// Dual-filter downsample: the center plus four diagonal taps, each bilinear
+// fetch averaging a 2x2 block of the larger source
+void main() {
+    vec4 sum = texture(screenTexture, TexCoord) * 4.0;
+    sum += texture(screenTexture, TexCoord - halfPixel);
+    sum += texture(screenTexture, TexCoord + halfPixel);
+    sum += texture(screenTexture, TexCoord + vec2(halfPixel.x, -halfPixel.y));
+    sum += texture(screenTexture, TexCoord - vec2(halfPixel.x, -halfPixel.y));
+    
+    FragColor = sum / 8.0;
+}
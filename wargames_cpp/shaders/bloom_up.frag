@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+uniform sampler2D screenTexture;
+uniform vec2 halfPixel; // half a texel of the smaller source level
+
+// Dual-filter upsample: an eight-tap tent around the destination texel
+void main() {
+    vec4 sum = texture(screenTexture, TexCoord + vec2(-halfPixel.x * 2.0, 0.0));
+    sum += texture(screenTexture, TexCoord + vec2(-halfPixel.x, halfPixel.y)) * 2.0;
+    sum += texture(screenTexture, TexCoord + vec2(0.0, halfPixel.y * 2.0));
+    sum += texture(screenTexture, TexCoord + vec2(halfPixel.x, halfPixel.y)) * 2.0;
+    sum += texture(screenTexture, TexCoord + vec2(halfPixel.x * 2.0, 0.0));
+    sum += texture(screenTexture, TexCoord + vec2(halfPixel.x, -halfPixel.y)) * 2.0;
+    sum += texture(screenTexture, TexCoord + vec2(0.0, -halfPixel.y * 2.0));
+    sum += texture(screenTexture, TexCoord + vec2(-halfPixel.x, -halfPixel.y)) * 2.0;
+    
+    FragColor = sum / 12.0;
+}
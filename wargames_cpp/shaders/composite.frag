@@ -4,31 +4,73 @@ out vec4 FragColor;
 in vec2 TexCoord;
 uniform sampler2D screenTexture;
 uniform sampler2D bloomTexture;
-uniform sampler2D scanlineTexture;
-uniform sampler2D vignetteTexture;
 uniform float noiseIntensity;
 uniform float bloomIntensity;
 uniform float flickerIntensity;
-uniform float time;
-uniform vec2 resolution;
+uniform float distortion;   // barrel distortion strength, 0 disables
+uniform float aberration;   // chromatic aberration strength, 0 disables
+// Per-frame values shared by all post-processing passes (binding 0)
+layout (std140) uniform FrameData {
+    vec2 resolution;
+    float time;
+};
 
 // Pseudo-random noise function
 float rand(vec2 co) {
     return fract(sin(dot(co.xy, vec2(12.9898, 78.233))) * 43758.5453);
 }
 
+// Every third output row is darkened, matching the old scanline texture
+float scanline() {
+    return (int(gl_FragCoord.y) % 3 == 0) ? 200.0 / 255.0 : 1.0;
+}
+
+// Radial falloff by pixel distance from the center, so it keeps the
+// screen's aspect ratio
+float vignette() {
+    vec2 halfSize = 0.5 * resolution;
+    float d = length((TexCoord - vec2(0.5)) * resolution) / length(halfSize);
+    return clamp(1.0 - pow(d, 1.8) * 0.6, 0.0, 1.0);
+}
+
+// Barrel distortion as a UV remap
+vec2 barrel(vec2 uv) {
+    vec2 cc = uv - vec2(0.5);
+    float dist = length(cc);
+    return vec2(0.5) + cc * (1.0 + dist * dist * distortion);
+}
+
+// Distorted scene sample, black outside the curved screen
+vec4 sampleScene(vec2 uv) {
+    vec2 distorted = barrel(uv);
+    if (distorted.x < 0.0 || distorted.x > 1.0 || distorted.y < 0.0 || distorted.y > 1.0) {
+        return vec4(0.0, 0.0, 0.0, 1.0);
+    }
+    return texture(screenTexture, distorted);
+}
+
 void main() {
-    vec4 color = texture(screenTexture, TexCoord);
-    vec4 bloom = texture(bloomTexture, TexCoord) * bloomIntensity;
+    // Chromatic aberration: each channel through the barrel at a slight offset
+    vec4 color;
+    if (aberration > 0.0) {
+        vec2 offset = (TexCoord - vec2(0.5)) * aberration * 0.01;
+        color = vec4(sampleScene(TexCoord + offset).r,
+                     sampleScene(TexCoord).g,
+                     sampleScene(TexCoord - offset).b,
+                     1.0);
+    } else {
+        color = sampleScene(TexCoord);
+    }
+    
+    // Bloom is built from the undistorted scene, so it takes the same remap
+    vec4 bloom = texture(bloomTexture, barrel(TexCoord)) * bloomIntensity;
     color += bloom;
     
     // Add scanlines
-    vec4 scanline = texture(scanlineTexture, TexCoord);
-    color *= mix(vec4(1.0), scanline, 0.5);
+    color *= mix(1.0, scanline(), 0.5);
     
     // Add vignette
-    vec4 vignette = texture(vignetteTexture, TexCoord);
-    color *= vignette;
+    color *= vignette();
     
     // Add noise
     float noise = rand(TexCoord + time) * noiseIntensity;
@@ -10,18 +10,23 @@ namespace {
     }
 }
 
-Aircraft::Aircraft(const LatLon& center, double radiusDeg, float loopSeconds, const Color& color)
-    : m_color(color)
+Aircraft::Aircraft(const LatLon& center, double radiusDeg, float loopSeconds, const Color& color,
+                   std::vector<Point>& loops)
+    : m_loops(&loops)
+    , m_first(0)
+    , m_count(0)
+    , m_color(color)
     , m_progress(0.0f)
+    , m_prevProgress(0.0f)
     , m_duration(loopSeconds)
     , m_trailLength(18)
 {
-    buildLoop(center, radiusDeg);
+    buildLoop(loops, center, radiusDeg);
 }
 
-void Aircraft::buildLoop(const LatLon& center, double radiusDeg, int samples) {
-    m_path.clear();
-    m_path.reserve(samples);
+void Aircraft::buildLoop(std::vector<Point>& loops, const LatLon& center, double radiusDeg, int samples) {
+    m_first = static_cast<uint32_t>(loops.size());
+    m_count = static_cast<uint32_t>(samples);
 
     for (int i = 0; i < samples; i++) {
         double t = static_cast<double>(i) / samples;
@@ -30,42 +35,48 @@ void Aircraft::buildLoop(const LatLon& center, double radiusDeg, int samples) {
         double lon = center.lon + radiusDeg * std::cos(angle);
         lon = wrapLongitude(lon);
 
-        m_path.push_back(lonlat_to_xy(lon, lat, SCREEN_WIDTH, SCREEN_HEIGHT));
+        loops.push_back(lonlat_to_world(lon, lat));
     }
 }
 
 void Aircraft::update(float dt) {
-    if (m_duration <= 0.0f || m_path.empty()) return;
+    if (m_duration <= 0.0f || m_count == 0) return;
 
+    m_prevProgress = m_progress;
     m_progress += dt / m_duration;
     if (m_progress >= 1.0f) {
         m_progress -= std::floor(m_progress);
     }
 }
 
-void Aircraft::draw(Renderer* renderer) const {
-    if (m_path.size() < 2) return;
+void Aircraft::draw(DrawList& list, float alpha) const {
+    if (m_count < 2) return;
 
-    int count = static_cast<int>(m_path.size());
-    int idx = static_cast<int>(m_progress * (count - 1));
-    if (idx < 0) idx = 0;
-    if (idx >= count) idx = count - 1;
+    // Unwrap across the end of the loop before blending
+    float current = m_progress;
+    if (current < m_prevProgress) current += 1.0f;
+    float progress = m_prevProgress + (current - m_prevProgress) * alpha;
+    progress -= std::floor(progress);
 
-    const Point head = m_path[idx];
-    renderer->drawCircleWithGlow(head.x, head.y, 3.0f, m_color, 3);
+    // Position between the two nearest loop samples; the loop is closed, so
+    // the last sample blends back into the first
+    const Point* path = m_loops->data() + m_first;
+    const int count = static_cast<int>(m_count);
+    const float position = progress * (count - 1);
+    const int idx = std::clamp(static_cast<int>(position), 0, count - 1);
+    const Point& a = path[idx];
+    const Point& b = path[(idx + 1) % count];
+    const float t = position - idx;
+    Point head(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t);
+    if (std::abs(b.x - a.x) > WORLD_WIDTH * 0.5f) head = a;    // the pair straddles the antimeridian
+    
+    // The tag box extends 20 px from the marker, plus its glow
+    if (!list.isVisible(Bounds{head.x, head.y, head.x, head.y}, 30.0f)) return;
+    
+    const ShapeInstance marker{head.x, head.y, 3.0f, 0.0f, m_color.r, m_color.g, m_color.b, m_color.a};
+    list.submitInstance(ShapeMesh::Circle, marker, 3);
 
     // Tag: short leader line + small box
-    const float tagOffsetX = 10.0f;
-    const float tagOffsetY = -8.0f;
-    const float tagW = 10.0f;
-    const float tagH = 6.0f;
-    const float tagX = head.x + tagOffsetX;
-    const float tagY = head.y + tagOffsetY;
-
-    Color tagColor(m_color.r, m_color.g, m_color.b, 0.8f);
-    renderer->drawLineWithGlow(head.x, head.y, tagX, tagY, tagColor, 2);
-    renderer->drawLineWithGlow(tagX, tagY, tagX + tagW, tagY, tagColor, 2);
-    renderer->drawLineWithGlow(tagX + tagW, tagY, tagX + tagW, tagY + tagH, tagColor, 2);
-    renderer->drawLineWithGlow(tagX + tagW, tagY + tagH, tagX, tagY + tagH, tagColor, 2);
-    renderer->drawLineWithGlow(tagX, tagY + tagH, tagX, tagY, tagColor, 2);
+    const ShapeInstance tag{head.x, head.y, 1.0f, 0.0f, m_color.r, m_color.g, m_color.b, 0.8f};
+    list.submitInstance(ShapeMesh::AircraftTag, tag, 2);
 }
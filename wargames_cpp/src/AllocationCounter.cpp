@@ -0,0 +1,115 @@
+#include "AllocationCounter.hpp"
+
+#ifdef WARGAMES_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+    std::atomic<uint64_t> g_allocations{0};
+
+    void* countedAllocate(std::size_t size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size > 0 ? size : 1);
+    }
+
+    // Over-aligned types (LockFreeQueue's cursors, for one) come through
+    // the align_val_t forms, so those are counted as well
+    void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+#ifdef _WIN32
+        return _aligned_malloc(size > 0 ? size : 1, static_cast<std::size_t>(alignment));
+#else
+        void* p = nullptr;
+        if (posix_memalign(&p, static_cast<std::size_t>(alignment), size > 0 ? size : 1) != 0) return nullptr;
+        return p;
+#endif
+    }
+
+    void freeAligned(void* p) {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+void* operator new(std::size_t size) {
+    void* p = countedAllocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = countedAllocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* p = countedAllocateAligned(size, alignment);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    void* p = countedAllocateAligned(size, alignment);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+
+bool AllocationCounter::isEnabled() {
+    return true;
+}
+
+uint64_t AllocationCounter::count() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::isEnabled() {
+    return false;
+}
+
+uint64_t AllocationCounter::count() {
+    return 0;
+}
+
+#endif
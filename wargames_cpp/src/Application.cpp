@@ -0,0 +1,993 @@
+#include "Application.hpp"
+#include "AllocationCounter.hpp"
+
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <glad/gl.h>
+
+namespace {
+    // Uniform block shared by the post-processing shaders (std140 layout)
+    struct FrameUniforms {
+        float resolution[2];
+        float time;
+        float padding;
+    };
+
+    constexpr GLuint FRAME_UNIFORM_BINDING = 0;
+
+    // How often --shader-dev looks for edited shaders
+    constexpr std::chrono::milliseconds SHADER_POLL_INTERVAL(250);
+
+    // Phosphor half-life when persistence is switched on without --phosphor
+    constexpr float DEFAULT_PHOSPHOR_HALF_LIFE = 1.5f;
+
+    // Smallest fade applied to the trail buffer. Half floats step by 2^-11
+    // to 2^-10 of their value, so a factor closer to 1 than that rounds to
+    // a no-op and the trails stop fading; 2^-9 moves every normal value.
+    constexpr double MIN_PHOSPHOR_FADE = 1.0 / 512.0;
+
+    std::string findDataFile(const std::string& filename) {
+        namespace fs = std::filesystem;
+        const std::array<std::string, 4> bases = {{
+            "data",
+            "wargames_cpp/data",
+            "../data",
+            "../../data"
+        }};
+
+        for (const auto& base : bases) {
+            fs::path path = fs::path(base) / filename;
+            if (fs::exists(path)) {
+                return path.string();
+            }
+        }
+
+        return filename;
+    }
+
+    std::string findShaderDirectory(const std::string& configured) {
+        if (!configured.empty()) {
+            return (std::filesystem::path(configured) / "").string();
+        }
+        for (const char* base : {"shaders", "wargames_cpp/shaders", "../shaders", "../../shaders"}) {
+            if (std::filesystem::exists(std::filesystem::path(base) / "basic.vert")) {
+                return std::string(base) + "/";
+            }
+        }
+        return "wargames_cpp/shaders/";
+    }
+
+    // $XDG_CACHE_HOME/wargames_cpp/programs, falling back to ~/.cache
+    std::string defaultShaderCacheDirectory() {
+        if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) {
+            return (std::filesystem::path(cacheHome) / "wargames_cpp" / "programs").string();
+        }
+        if (const char* home = std::getenv("HOME"); home && *home) {
+            return (std::filesystem::path(home) / ".cache" / "wargames_cpp" / "programs").string();
+        }
+        return "";
+    }
+
+    // Most detailed Natural Earth resolution present wins; the map's
+    // level-of-detail pipeline keeps the drawn vertex count bounded
+    std::string findMapDataFile(const std::string& layer) {
+        for (const char* resolution : {"10m", "50m"}) {
+            std::string path = findDataFile("ne_" + std::string(resolution) + "_" + layer + ".shp");
+            if (std::filesystem::exists(path)) {
+                return path;
+            }
+        }
+        return findDataFile("ne_110m_" + layer + ".shp");
+    }
+
+    uint32_t seedFor(const AppConfig& config) {
+        if (config.fixedSeed) return config.seed;
+        std::random_device rd;
+        return rd();
+    }
+
+    SimulationConfig simulationConfigFor(const AppConfig& config) {
+        SimulationConfig simulation;
+        simulation.seed = seedFor(config);
+        simulation.tickHz = config.simulationHz;
+        simulation.launchInterval = config.launchInterval;
+        simulation.burstInterval = config.burstInterval;
+        simulation.initialMissiles = config.initialMissiles;
+        simulation.aircraftCount = config.aircraftCount;
+        return simulation;
+    }
+}
+
+Application::Application(const AppConfig& config)
+    : m_config(config)
+    , m_shaderDir(findShaderDirectory(config.shaderDir))
+    , m_renderer(config.width, config.height)
+    , m_vectorMap(&m_renderer)
+    , m_bloomPrograms(&m_renderer)
+    , m_perfHud(&m_renderer)
+    , m_screenUseTextureLoc(-1)
+    , m_screenColorLoc(-1)
+    , m_compositeNoiseLoc(-1)
+    , m_compositeBloomLoc(-1)
+    , m_compositeFlickerLoc(-1)
+    , m_compositeDistortionLoc(-1)
+    , m_compositeAberrationLoc(-1)
+    , m_frameUbo(0)
+    , m_simulation(simulationConfigFor(config), &m_jobs)
+    , m_readySnapshot(0)
+    , m_simPending(false)
+    , m_simStopping(false)
+    , m_simSeconds(0.0)
+    , m_simTarget(0)
+    , m_running(false)
+    , m_fullscreen(false)
+    , m_showPerfHud(false)
+    , m_phosphorHalfLife(config.phosphorHalfLife)
+    , m_crtMode(config.crtMode)
+    , m_initialized(false)
+{
+    m_input.launchInterval = config.launchInterval;
+    m_input.persistentTrails = config.phosphorHalfLife > 0.0f;
+    m_input.gpuTrails = config.gpuTrails;
+}
+
+Application::~Application() {
+    shutdown();
+}
+
+bool Application::initialize() {
+    // Initialize SDL
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        std::cerr << "Failed to initialize SDL: " << SDL_GetError() << "\n";
+        return false;
+    }
+
+    // Create renderer
+    WindowSettings settings;
+    settings.vsync = m_config.vsync;
+    settings.hidden = m_config.hiddenWindow;
+    if (m_config.shaderCache) {
+        settings.shaderCacheDir = m_config.shaderCacheDir.empty()
+            ? defaultShaderCacheDirectory() : m_config.shaderCacheDir;
+    }
+    if (!m_renderer.initialize(settings)) {
+        std::cerr << "Failed to initialize renderer\n";
+        SDL_Quit();
+        return false;
+    }
+    m_initialized = true;
+
+    if (m_input.gpuTrails && !m_renderer.supportsGpuTrails()) {
+        std::cerr << "Warning: GPU trails unavailable, copying trail points instead\n";
+        m_input.gpuTrails = false;
+    }
+
+    m_profiler.initialize();
+    if (!m_config.profileOut.empty() && m_profiler.openDump(m_config.profileOut)) {
+        std::cout << "Writing profiler stats to " << m_config.profileOut << "\n";
+    }
+
+    // Load vector map
+    std::string coastlinePath = findMapDataFile("coastline");
+    std::string countriesPath = findMapDataFile("admin_0_countries");
+    if (!m_vectorMap.loadShapefiles(coastlinePath, countriesPath)) {
+        std::cerr << "Warning: Failed to load shapefiles. Make sure data files are in data/ directory\n";
+    }
+
+    // Post-processing resources per output, reallocated whenever its window resizes
+    if (!createOutputs()) {
+        std::cerr << "Failed to open the display wall\n";
+        return false;
+    }
+    applyView();
+    setupPostProcessing();
+
+    const ShaderCache& shaderCache = m_renderer.getShaderCache();
+    if (shaderCache.isEnabled()) {
+        std::cout << "Shader programs: " << shaderCache.hits() << " from cache, "
+                  << shaderCache.misses() << " compiled\n";
+    }
+    if (m_config.shaderHotReload) {
+        m_shaderWatcher.watch(m_shaderDir);
+        std::cout << "Watching " << m_shaderDir << " for shader changes\n";
+    }
+
+    if (!m_config.capture.empty()) {
+        // Y4M needs a frame rate; a fixed timestep gives the exact one
+        const int captureFps = (m_config.fixedTimestep > 0.0f)
+            ? static_cast<int>(std::lround(1.0f / m_config.fixedTimestep)) : m_config.targetFps;
+        const Output& primary = *m_outputs[0];
+        if (!m_capture.open(m_config.capture, primary.width, primary.height, captureFps)) {
+            std::cerr << "Warning: Capture unavailable\n";
+        }
+    }
+
+    m_simulation.initialize();
+
+    if (!m_config.feed.empty()) {
+        if (m_feed.open(m_config.feed, m_config.replaySpeed)) {
+            m_simulation.attachFeed(&m_feed);
+            std::cout << (m_feed.isLive() ? "Launching from live feed " : "Replaying launches from ")
+                      << m_config.feed << "\n";
+        } else {
+            std::cerr << "Warning: Feed unavailable, using random launches\n";
+        }
+    }
+
+    return true;
+}
+
+bool Application::setupPostProcessing() {
+    // Per-frame values shared by every post pass through one uniform buffer
+    glGenBuffers(1, &m_frameUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, m_frameUbo);
+
+    return loadPostShaders();
+}
+
+bool Application::loadPostShaders() {
+    ShaderProgram screen(m_renderer.loadShader(m_shaderDir + "basic.vert", m_shaderDir + "basic.frag"));
+    ShaderProgram composite(m_renderer.loadShader(m_shaderDir + "basic.vert", m_shaderDir + "composite.frag"));
+    const bool built = screen.isValid() && composite.isValid();
+
+    // On a reload, a program that fails to build keeps the one already running
+    if (screen.isValid()) m_screenShader = std::move(screen);
+    if (composite.isValid()) m_compositeShader = std::move(composite);
+
+    const float identity[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    // Everything that never changes is set once here
+    for (const ShaderProgram* program : {&m_screenShader, &m_compositeShader}) {
+        if (!program->isValid()) continue;
+        program->use();
+        glUniformMatrix4fv(program->uniform("projection"), 1, GL_FALSE, identity);
+        glUniform1i(program->uniform("screenTexture"), 0);
+        program->bindUniformBlock("FrameData", FRAME_UNIFORM_BINDING);
+    }
+
+    m_screenShader.use();
+    m_screenUseTextureLoc = m_screenShader.uniform("useTexture");
+    m_screenColorLoc = m_screenShader.uniform("color");
+    glUniform1i(m_screenUseTextureLoc, 1);
+    glUniform4f(m_screenColorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
+    glUniform1i(m_screenShader.uniform("tex"), 0);
+
+    m_compositeShader.use();
+    glUniform1i(m_compositeShader.uniform("bloomTexture"), 1);
+
+    m_compositeNoiseLoc = m_compositeShader.uniform("noiseIntensity");
+    m_compositeBloomLoc = m_compositeShader.uniform("bloomIntensity");
+    m_compositeFlickerLoc = m_compositeShader.uniform("flickerIntensity");
+    m_compositeDistortionLoc = m_compositeShader.uniform("distortion");
+    m_compositeAberrationLoc = m_compositeShader.uniform("aberration");
+    glUseProgram(0);
+
+    return built;
+}
+
+void Application::reloadShaders() {
+    const bool post = loadPostShaders();
+    const bool bloom = m_bloomPrograms.load(m_shaderDir);
+    std::cout << (post && bloom ? "Shaders reloaded\n" : "Shader reload failed; keeping the previous programs\n");
+}
+
+void Application::shutdown() {
+    stopSimulationThread();
+    if (m_feed.isOpen()) {
+        const ScenarioFeed::Stats feed = m_feed.stats();
+        std::cout << "Feed: " << feed.parsed << " records, " << feed.rejected << " rejected, "
+                  << feed.dropped << " dropped\n";
+        m_feed.close();
+    }
+    if (!m_initialized) return;
+
+    if (m_capture.isOpen()) {
+        m_capture.close();
+        m_stats.capture = m_capture.stats();
+        std::cout << "Capture: " << m_stats.capture.written << " frames written, "
+                  << m_stats.capture.dropped << " dropped\n";
+    }
+
+    // Cleanup
+    for (ShaderProgram* program : {&m_screenShader, &m_compositeShader}) {
+        program->destroy();
+    }
+    for (auto& output : m_outputs) {
+        output->bloom.destroy();
+        destroySceneTarget(*output);
+        m_renderer.destroyWindow(output->window);
+    }
+    m_outputs.clear();
+    m_bloomPrograms.destroy();
+    if (m_frameUbo) glDeleteBuffers(1, &m_frameUbo);
+    m_frameUbo = 0;
+    m_profiler.shutdown();
+    m_renderer.shutdown();
+    SDL_Quit();
+    m_initialized = false;
+}
+
+bool Application::createOutputs() {
+    const int columns = std::max(1, m_config.wallColumns);
+    const int rows = std::max(1, m_config.wallRows);
+    const int count = columns * rows;
+
+    // Tile i, in row-major order, goes fullscreen on display i when every
+    // tile has a display; otherwise the tiles are windows side by side,
+    // together the configured size
+    const bool perDisplay = count > 1 && !m_config.hiddenWindow && SDL_GetNumVideoDisplays() >= count;
+    SDL_Rect area = {0, 0, m_config.width, m_config.height};
+    if (count > 1 && !perDisplay && SDL_GetDisplayUsableBounds(0, &area) == 0) {
+        area.x += std::max(0, (area.w - m_config.width) / 2);
+        area.y += std::max(0, (area.h - m_config.height) / 2);
+    }
+    const int tileWidth = std::max(1, m_config.width / columns);
+    const int tileHeight = std::max(1, m_config.height / rows);
+
+    // The bloom passes are built once; each output only allocates its chain
+    if (!m_bloomPrograms.load(m_shaderDir)) {
+        std::cerr << "Failed to load bloom shaders\n";
+    }
+
+    m_vectorMap.setViewCount(count);
+    for (int i = 0; i < count; i++) {
+        const int column = i % columns;
+        const int row = i / columns;
+
+        SDL_Rect bounds = {area.x + column * tileWidth, area.y + row * tileHeight, tileWidth, tileHeight};
+        if (perDisplay) SDL_GetDisplayBounds(i, &bounds);
+
+        auto output = std::make_unique<Output>(&m_renderer, &m_bloomPrograms);
+        output->tile = ViewTile{static_cast<float>(column) / columns, static_cast<float>(row) / rows,
+                                1.0f / columns, 1.0f / rows};
+        if (i == 0) {
+            output->window = m_renderer.getWindow();
+            if (perDisplay) {
+                SDL_SetWindowPosition(output->window, bounds.x, bounds.y);
+                SDL_SetWindowFullscreen(output->window, SDL_WINDOW_FULLSCREEN_DESKTOP);
+            } else if (count > 1) {
+                SDL_SetWindowSize(output->window, bounds.w, bounds.h);
+                SDL_SetWindowPosition(output->window, bounds.x, bounds.y);
+            }
+        } else {
+            const std::string title = "WarGames Map " + std::to_string(i + 1);
+            output->window = m_renderer.createWindow(title.c_str(), bounds, perDisplay, m_config.hiddenWindow);
+            if (!output->window) return false;
+        }
+        SDL_GL_GetDrawableSize(output->window, &output->width, &output->height);
+
+        createSceneTarget(*output);
+        output->bloom.resize(output->scene.width, output->scene.height);
+        m_outputs.push_back(std::move(output));
+    }
+    m_fullscreen = perDisplay;
+
+    if (count > 1) {
+        std::cout << "Display wall: " << columns << "x" << rows
+                  << (perDisplay ? " tiles, one display each\n" : " tiles in windows\n");
+    }
+    return true;
+}
+
+void Application::destroySceneTarget(Output& output) {
+    SceneTarget& scene = output.scene;
+    if (scene.texture) glDeleteTextures(1, &scene.texture);
+    if (scene.fbo) glDeleteFramebuffers(1, &scene.fbo);
+    scene = SceneTarget{};
+
+    destroyTrailTarget(output);
+}
+
+void Application::createSceneTarget(Output& output) {
+    destroySceneTarget(output);
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+    auto scaled = [&](int size) {
+        int value = static_cast<int>(size * m_config.renderScale + 0.5f);
+        return std::clamp(value, 1, maxSize > 0 ? static_cast<int>(maxSize) : value);
+    };
+
+    SceneTarget& scene = output.scene;
+    scene.width = scaled(output.width);
+    scene.height = scaled(output.height);
+    scene.fbo = m_renderer.createFramebuffer(scene.width, scene.height, scene.texture);
+
+    if (m_input.persistentTrails) createTrailTarget(output);
+}
+
+void Application::createTrailTarget(Output& output) {
+    destroyTrailTarget(output);
+
+    SceneTarget& trails = output.trails;
+    trails.width = output.scene.width;
+    trails.height = output.scene.height;
+    trails.fbo = m_renderer.createFramebuffer(trails.width, trails.height, trails.texture, GL_RGBA16F);
+    m_renderer.bindFramebuffer(trails.fbo, trails.width, trails.height);
+    m_renderer.clear(Color(0.0f, 0.0f, 0.0f, 0.0f));
+    m_renderer.unbindFramebuffer();
+
+    m_input.redrawTrails = true;
+}
+
+void Application::destroyTrailTarget(Output& output) {
+    SceneTarget& trails = output.trails;
+    if (trails.texture) glDeleteTextures(1, &trails.texture);
+    if (trails.fbo) glDeleteFramebuffers(1, &trails.fbo);
+    trails = SceneTarget{};
+}
+
+void Application::applyView() {
+    m_renderer.setView(m_view);
+    m_view = m_renderer.getView();
+
+    // Trails in the phosphor buffers were drawn under the old view
+    m_input.redrawTrails = true;
+}
+
+void Application::selectOutput(size_t index) {
+    Output& output = *m_outputs[index];
+    m_renderer.selectWindow(output.window, output.width, output.height);
+    m_renderer.setViewTile(output.tile);
+
+    // Both setters return early unless this output's view changed
+    m_vectorMap.setActiveView(static_cast<int>(index));
+    m_vectorMap.setViewScale(output.scene.width / (WORLD_WIDTH * output.tile.width) * m_view.zoom);
+
+    const Bounds* visibleRects = nullptr;
+    int visibleCount = m_renderer.getVisibleRects(visibleRects);
+    m_vectorMap.setVisibleRects(visibleRects, visibleCount);
+}
+
+int Application::run() {
+    if (!m_initialized) return 1;
+
+    m_running = true;
+    const bool recording = m_config.maxFrames > 0;
+    if (recording) {
+        m_stats.frameMs.reserve(m_config.maxFrames);
+        m_stats.liveMissiles.reserve(m_config.maxFrames);
+        m_stats.allocations.reserve(m_config.maxFrames);
+    }
+
+    // Timing. The simulation runs in fixed ticks fed from an accumulator;
+    // rendering runs as fast as vsync or the pacer allows and interpolates
+    // between the last two ticks.
+    using Clock = std::chrono::steady_clock;
+    const auto targetFrameTime = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(1, m_config.targetFps)));
+    const bool paced = m_config.frameLimit && !m_renderer.isVsyncActive();
+
+    // The first snapshot shows the initial state. With the simulation
+    // thread, every later step runs while the previous snapshot renders, so
+    // what is on screen is one frame behind the input.
+    setupSnapshot(m_snapshots[0]);
+    stepSimulation(m_snapshots[0], 0.0, m_input);
+    m_input.redrawTrails = false;
+    m_readySnapshot = 0;
+    if (m_config.threadedSimulation) startSimulationThread();
+
+    auto runStart = Clock::now();
+    auto lastTime = runStart;
+    auto nextFrame = runStart + targetFrameTime;
+    auto nextShaderPoll = runStart;
+    uint64_t lastAllocations = AllocationCounter::count();
+    int frame = 0;
+
+    // Main loop
+    while (m_running) {
+        m_profiler.beginFrame();
+        m_renderer.resetFrameStats();
+
+        auto currentTime = Clock::now();
+        double deltaTime = std::chrono::duration<double>(currentTime - lastTime).count();
+        lastTime = currentTime;
+
+        // Cap delta time to prevent spiral of death
+        if (deltaTime > 0.25) deltaTime = 0.25;
+        if (m_config.fixedTimestep > 0.0f) deltaTime = m_config.fixedTimestep;
+
+        handleEvents();
+
+        if (m_config.shaderHotReload && currentTime >= nextShaderPoll) {
+            nextShaderPoll = currentTime + SHADER_POLL_INTERVAL;
+            if (m_shaderWatcher.poll()) reloadShaders();
+        }
+
+        // Input is consumed by exactly one step
+        const SimulationInput input = m_input;
+        m_input.bursts = 0;
+        m_input.redrawTrails = false;
+
+        FrameSnapshot* snapshot = nullptr;
+        {
+            // Threaded, this only measures how long rendering waited
+            Profiler::Scope scope(m_profiler, Profiler::Section::Update);
+            if (m_simThread.joinable()) {
+                snapshot = &waitForSnapshot();
+                requestSnapshot(deltaTime, input);
+            } else {
+                snapshot = &m_snapshots[0];
+                setupSnapshot(*snapshot);
+                stepSimulation(*snapshot, deltaTime, input);
+            }
+        }
+
+        render(*snapshot);
+
+        const FrameStats& stats = m_renderer.getFrameStats();
+        m_profiler.setCounter(Profiler::Counter::DrawCalls, stats.drawCalls);
+        m_profiler.setCounter(Profiler::Counter::UploadBytes, static_cast<double>(stats.uploadBytes));
+        m_profiler.setCounter(Profiler::Counter::LiveMissiles, snapshot->liveMissiles);
+        m_profiler.setCounter(Profiler::Counter::Explosions, snapshot->explosions);
+        m_profiler.setCounter(Profiler::Counter::SimulationMs, snapshot->stepMs);
+
+        const uint64_t allocations = AllocationCounter::count();
+        const uint32_t frameAllocations = static_cast<uint32_t>(allocations - lastAllocations);
+        lastAllocations = allocations;
+        m_profiler.setCounter(Profiler::Counter::Allocations, frameAllocations);
+
+        if (m_profiler.endFrame()) {
+            m_perfHud.update(m_profiler.report());
+        }
+
+        auto frameTime = Clock::now() - currentTime;
+        if (recording) {
+            m_stats.frameMs.push_back(std::chrono::duration<double, std::milli>(frameTime).count());
+            m_stats.liveMissiles.push_back(snapshot->liveMissiles);
+            m_stats.allocations.push_back(frameAllocations);
+            if (++frame >= m_config.maxFrames) m_running = false;
+        }
+
+        // Frame pacing when vsync is off or unavailable. Deadlines advance by
+        // the target period so sleep error does not accumulate; a frame that
+        // ran late restarts the schedule instead of rushing to catch up.
+        if (paced) {
+            waitUntil(nextFrame);
+            nextFrame += targetFrameTime;
+            if (nextFrame < Clock::now()) nextFrame = Clock::now() + targetFrameTime;
+        }
+    }
+
+    stopSimulationThread();
+    m_stats.seconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+    m_stats.missilesLaunched = m_simulation.missilesLaunched();
+    m_stats.feed = m_feed.stats();
+    return 0;
+}
+
+void Application::setupSnapshot(FrameSnapshot& snapshot) const {
+    m_renderer.setupDrawList(snapshot.entities);
+    m_renderer.setupDrawList(snapshot.trails);
+}
+
+void Application::stepSimulation(FrameSnapshot& snapshot, double seconds, const SimulationInput& input) {
+    const auto start = std::chrono::steady_clock::now();
+
+    m_simulation.step(seconds, input);
+    m_simulation.buildDrawList(snapshot.entities, input.persistentTrails ? &snapshot.trails : nullptr,
+                               input.redrawTrails, input.gpuTrails);
+    snapshot.persistentTrails = input.persistentTrails;
+    snapshot.trailsReset = input.redrawTrails;
+    snapshot.time = m_simulation.interpolatedTime();
+    snapshot.liveMissiles = static_cast<uint32_t>(m_simulation.liveMissiles());
+    snapshot.explosions = static_cast<uint32_t>(m_simulation.explosionCount());
+
+    snapshot.stepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Application::startSimulationThread() {
+    m_simPending = false;
+    m_simStopping = false;
+    m_simThread = std::thread(&Application::simulationLoop, this);
+}
+
+void Application::stopSimulationThread() {
+    if (!m_simThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_simMutex);
+        m_simStopping = true;
+    }
+    m_simWake.notify_one();
+    m_simThread.join();
+}
+
+void Application::simulationLoop() {
+    std::unique_lock<std::mutex> lock(m_simMutex);
+    while (true) {
+        m_simWake.wait(lock, [this] { return m_simPending || m_simStopping; });
+        if (m_simStopping) return;
+
+        // The target snapshot is not read by the render thread until this
+        // request completes, so it is filled without holding the lock
+        const double seconds = m_simSeconds;
+        const SimulationInput input = m_simInput;
+        const int target = m_simTarget;
+        lock.unlock();
+
+        stepSimulation(m_snapshots[target], seconds, input);
+
+        lock.lock();
+        m_readySnapshot = target;
+        m_simPending = false;
+        m_simDone.notify_one();
+    }
+}
+
+Application::FrameSnapshot& Application::waitForSnapshot() {
+    std::unique_lock<std::mutex> lock(m_simMutex);
+    m_simDone.wait(lock, [this] { return !m_simPending; });
+    return m_snapshots[m_readySnapshot];
+}
+
+void Application::requestSnapshot(double seconds, const SimulationInput& input) {
+    // The other snapshot was drawn last frame and is free again. Culling
+    // and glow mode are taken from the renderer now, on this thread.
+    const int target = 1 - m_readySnapshot;
+    setupSnapshot(m_snapshots[target]);
+    {
+        std::lock_guard<std::mutex> lock(m_simMutex);
+        m_simSeconds = seconds;
+        m_simInput = input;
+        m_simTarget = target;
+        m_simPending = true;
+    }
+    m_simWake.notify_one();
+}
+
+void Application::waitUntil(std::chrono::steady_clock::time_point deadline) const {
+    using Clock = std::chrono::steady_clock;
+    const auto spinMargin = std::chrono::microseconds(1500);
+
+    auto now = Clock::now();
+    if (deadline - now > spinMargin) {
+        std::this_thread::sleep_for(deadline - now - spinMargin);
+    }
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void Application::handleEvents() {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            m_running = false;
+        } else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE) {
+            // With several windows SDL_QUIT only follows the last one closing
+            m_running = false;
+        } else if (event.type == SDL_WINDOWEVENT &&
+                   event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+            for (auto& output : m_outputs) {
+                if (SDL_GetWindowID(output->window) != event.window.windowID) continue;
+
+                // Event sizes are in window points; targets need drawable pixels
+                int drawableWidth = 0;
+                int drawableHeight = 0;
+                SDL_GL_GetDrawableSize(output->window, &drawableWidth, &drawableHeight);
+                if (drawableWidth > 0 && drawableHeight > 0 &&
+                    (drawableWidth != output->width || drawableHeight != output->height)) {
+                    output->width = drawableWidth;
+                    output->height = drawableHeight;
+                    createSceneTarget(*output);
+                    output->bloom.resize(output->scene.width, output->scene.height);
+                    std::cout << "Resized to " << drawableWidth << "x" << drawableHeight
+                              << " (scene " << output->scene.width << "x" << output->scene.height << ")\n";
+                }
+            }
+        } else if (event.type == SDL_KEYDOWN && m_config.acceptInput) {
+            handleKey(event.key.keysym.sym);
+        }
+    }
+}
+
+void Application::handleKey(SDL_Keycode key) {
+    switch (key) {
+        case SDLK_ESCAPE:
+        case SDLK_q:
+            m_running = false;
+            break;
+
+        case SDLK_UP:
+            m_input.launchInterval = std::max(0.3f, m_input.launchInterval - 0.5f);
+            std::cout << "Launch interval: " << m_input.launchInterval << "s\n";
+            break;
+
+        case SDLK_DOWN:
+            m_input.launchInterval = std::min(10.0f, m_input.launchInterval + 0.5f);
+            std::cout << "Launch interval: " << m_input.launchInterval << "s\n";
+            break;
+
+        case SDLK_r:
+            m_input.launchInterval = 2.0f;
+            std::cout << "Reset to default intensity\n";
+            break;
+
+        case SDLK_SPACE:
+            std::cout << "BURST MODE!\n";
+            m_input.bursts++;
+            break;
+
+        case SDLK_c:
+            // Cycle CRT mode
+            switch (m_crtMode) {
+                case CRTMode::OFF:
+                    m_crtMode = CRTMode::LIGHT;
+                    std::cout << "CRT Mode: LIGHT\n";
+                    break;
+                case CRTMode::LIGHT:
+                    m_crtMode = CRTMode::FULL;
+                    std::cout << "CRT Mode: FULL\n";
+                    break;
+                case CRTMode::FULL:
+                    m_crtMode = CRTMode::OFF;
+                    std::cout << "CRT Mode: OFF\n";
+                    break;
+            }
+            break;
+
+        case SDLK_g:
+            if (m_renderer.getGlowMode() == Renderer::GlowMode::Layered) {
+                m_renderer.setGlowMode(Renderer::GlowMode::Shader);
+            } else {
+                m_renderer.setGlowMode(Renderer::GlowMode::Layered);
+            }
+            std::cout << (m_renderer.getGlowMode() == Renderer::GlowMode::Shader
+                ? "Glow: SHADER\n" : "Glow: LAYERED\n");
+            break;
+
+        case SDLK_w:
+        case SDLK_s:
+        case SDLK_a:
+        case SDLK_d:
+        case SDLK_LEFTBRACKET:
+        case SDLK_RIGHTBRACKET:
+        case SDLK_EQUALS:
+        case SDLK_PLUS:
+        case SDLK_KP_PLUS:
+        case SDLK_MINUS:
+        case SDLK_KP_MINUS:
+        case SDLK_HOME: {
+            // View changes are pure uniform updates; nothing is reloaded
+            const float panStep = 10.0f / m_view.zoom;
+            if (key == SDLK_w) m_view.centerLat += panStep;
+            if (key == SDLK_s) m_view.centerLat -= panStep;
+            if (key == SDLK_a) m_view.centerLon -= panStep;
+            if (key == SDLK_d) m_view.centerLon += panStep;
+            if (key == SDLK_LEFTBRACKET) m_view.centerLon -= 30.0f;
+            if (key == SDLK_RIGHTBRACKET) m_view.centerLon += 30.0f;
+            if (key == SDLK_EQUALS || key == SDLK_PLUS || key == SDLK_KP_PLUS) {
+                m_view.zoom = std::min(m_view.zoom * 1.25f, 64.0f);
+            }
+            if (key == SDLK_MINUS || key == SDLK_KP_MINUS) m_view.zoom /= 1.25f;
+            if (key == SDLK_HOME) m_view = MapView{};
+
+            applyView();
+            break;
+        }
+
+        case SDLK_t:
+            if (m_input.persistentTrails) {
+                m_input.persistentTrails = false;
+                for (auto& output : m_outputs) {
+                    destroyTrailTarget(*output);
+                }
+                std::cout << "Trails: REDRAWN\n";
+            } else {
+                if (m_phosphorHalfLife <= 0.0f) m_phosphorHalfLife = DEFAULT_PHOSPHOR_HALF_LIFE;
+                m_input.persistentTrails = true;
+                for (auto& output : m_outputs) {
+                    createTrailTarget(*output);
+                }
+                std::cout << "Trails: PHOSPHOR (half-life " << m_phosphorHalfLife << "s)\n";
+            }
+            break;
+
+        case SDLK_v:
+            if (m_renderer.supportsGpuTrails()) {
+                m_input.gpuTrails = !m_input.gpuTrails;
+                std::cout << (m_input.gpuTrails ? "Trail points: GPU buffer\n" : "Trail points: CPU copy\n");
+            }
+            break;
+
+        case SDLK_F3:
+            m_showPerfHud = !m_showPerfHud;
+            std::cout << (m_showPerfHud ? "Performance overlay ON\n" : "Performance overlay OFF\n");
+            break;
+
+        case SDLK_f:
+            m_fullscreen = !m_fullscreen;
+            for (auto& output : m_outputs) {
+                SDL_SetWindowFullscreen(output->window, m_fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
+            }
+            std::cout << (m_fullscreen ? "Fullscreen ON\n" : "Fullscreen OFF\n");
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Application::updateTrails(Output& output, FrameSnapshot& snapshot) {
+    Profiler::Scope scope(m_profiler, Profiler::Section::Trails, &output == m_outputs[0].get());
+    m_renderer.bindFramebuffer(output.trails.fbo, output.trails.width, output.trails.height);
+    glEnable(GL_BLEND);
+
+    // Multiply by the decay over the simulated time since the last fade, so
+    // the look does not depend on the frame rate. A fade too small for the
+    // buffer to represent is put off until enough time has built up.
+    const double elapsed = std::max(0.0, snapshot.time - output.trailTime);
+    const double decay = std::pow(0.5, elapsed / m_phosphorHalfLife);
+    if (snapshot.trailsReset) {
+        m_renderer.clear(Color(0.0f, 0.0f, 0.0f, 0.0f));
+        output.trailTime = snapshot.time;
+    } else if (1.0 - decay >= MIN_PHOSPHOR_FADE) {
+        glBlendFunc(GL_ZERO, GL_SRC_COLOR);
+        m_screenShader.use();
+        glUniform1i(m_screenUseTextureLoc, 0);
+        const float fade = static_cast<float>(decay);
+        glUniform4f(m_screenColorLoc, fade, fade, fade, fade);
+        m_renderer.renderFullscreenQuad();
+        glUniform1i(m_screenUseTextureLoc, 1);
+        glUniform4f(m_screenColorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
+        output.trailTime = snapshot.time;
+    }
+
+    // Only the segments advanced since the last snapshot, unless it was reset.
+    // Every output draws them, so the list is kept until the next step.
+    m_renderer.setAdditiveBlending(true);
+    m_renderer.drawRetained(snapshot.trails);
+    m_renderer.setAdditiveBlending(false);
+}
+
+void Application::render(FrameSnapshot& snapshot) {
+    // The primary output goes last: its swap is the one that waits for
+    // vsync, and by then the other windows have been queued
+    for (size_t i = m_outputs.size(); i-- > 0; ) {
+        selectOutput(i);
+        renderOutput(*m_outputs[i], snapshot, i == 0);
+    }
+}
+
+void Application::renderOutput(Output& output, FrameSnapshot& snapshot, bool primary) {
+    // A section has one timer query per frame, so only the primary output
+    // is timed on the GPU; CPU times add up over all outputs
+    const bool gpuTimed = primary;
+    const SceneTarget& scene = output.scene;
+
+    if (snapshot.persistentTrails && output.trails.fbo) updateTrails(output, snapshot);
+
+    // Render scene to framebuffer
+    m_profiler.beginSection(Profiler::Section::Scene, gpuTimed);
+    m_renderer.bindFramebuffer(scene.fbo, scene.width, scene.height);
+    m_renderer.clear();
+    m_renderer.setAdditiveBlending(true);
+    m_renderer.beginBatch();
+
+    if (snapshot.persistentTrails && output.trails.fbo) {
+        // The buffer already holds faded, additively blended color
+        m_screenShader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, output.trails.texture);
+        m_renderer.renderFullscreenQuad();
+    }
+
+    // Draw vector map
+    {
+        Profiler::Scope scope(m_profiler, Profiler::Section::Map);
+        m_vectorMap.draw();
+    }
+
+    {
+        // Aircraft, missiles and explosions were culled and recorded by the
+        // simulation; only the upload and draw happen here. Blending is
+        // additive, so drawing them ahead of the batched map lines changes
+        // nothing. The list is kept for the other outputs and emptied when
+        // the next step is set up.
+        Profiler::Scope scope(m_profiler, Profiler::Section::Entities);
+        m_renderer.drawRetained(snapshot.entities);
+    }
+
+    {
+        Profiler::Scope scope(m_profiler, Profiler::Section::Flush);
+        m_renderer.flushBatch();
+    }
+    m_renderer.setAdditiveBlending(false);
+    m_renderer.unbindFramebuffer();
+    m_profiler.endSection(Profiler::Section::Scene);
+
+    glDisable(GL_BLEND);
+
+    // Simulation time keeps the noise and flicker repeatable under a fixed timestep
+    FrameUniforms frameUniforms = {};
+    frameUniforms.resolution[0] = static_cast<float>(m_renderer.getWidth());
+    frameUniforms.resolution[1] = static_cast<float>(m_renderer.getHeight());
+    frameUniforms.time = static_cast<float>(snapshot.time);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frameUniforms);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    if (m_crtMode == CRTMode::OFF) {
+        Profiler::Scope scope(m_profiler, Profiler::Section::Composite, gpuTimed);
+        m_screenShader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene.texture);
+        m_renderer.renderFullscreenQuad();
+    } else if (m_crtMode == CRTMode::LIGHT) {
+        Profiler::Scope scope(m_profiler, Profiler::Section::Composite, gpuTimed);
+        m_compositeShader.use();
+        glUniform1f(m_compositeNoiseLoc, 0.02f);
+        glUniform1f(m_compositeBloomLoc, 0.0f);
+        glUniform1f(m_compositeFlickerLoc, 0.0f);
+        glUniform1f(m_compositeDistortionLoc, 0.0f);
+        glUniform1f(m_compositeAberrationLoc, 0.0f);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene.texture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, scene.texture);
+
+        m_renderer.renderFullscreenQuad();
+    } else {
+        // Bloom through the downsample chain
+        GLuint bloomTex = scene.texture;
+        if (output.bloom.isValid()) {
+            Profiler::Scope scope(m_profiler, Profiler::Section::Bloom, gpuTimed);
+            bloomTex = output.bloom.process(scene.texture);
+        }
+
+        // Barrel distortion, chromatic aberration and composite in one pass
+        Profiler::Scope scope(m_profiler, Profiler::Section::Composite, gpuTimed);
+        m_compositeShader.use();
+        glUniform1f(m_compositeNoiseLoc, 0.03f);
+        glUniform1f(m_compositeBloomLoc, 0.35f);
+        glUniform1f(m_compositeFlickerLoc, 0.02f);
+        glUniform1f(m_compositeDistortionLoc, 0.08f);
+        glUniform1f(m_compositeAberrationLoc, 1.8f);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene.texture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, bloomTex);
+
+        m_renderer.renderFullscreenQuad();
+    }
+
+    if (primary && m_capture.isOpen()) {
+        // The finished frame, without the performance overlay
+        Profiler::Scope scope(m_profiler, Profiler::Section::Capture, gpuTimed);
+        m_capture.capture(m_renderer.getWidth(), m_renderer.getHeight());
+    }
+
+    glEnable(GL_BLEND);
+
+    if (primary && m_showPerfHud) {
+        Profiler::Scope scope(m_profiler, Profiler::Section::Hud);
+        m_renderer.setAdditiveBlending(true);
+        m_perfHud.draw();
+        m_renderer.setAdditiveBlending(false);
+    }
+
+    {
+        Profiler::Scope scope(m_profiler, Profiler::Section::Present);
+        m_renderer.present();
+    }
+}
@@ -0,0 +1,126 @@
+#include "BloomChain.hpp"
+#include <algorithm>
+#include <utility>
+
+BloomPrograms::BloomPrograms(Renderer* renderer)
+    : m_renderer(renderer)
+    , m_downHalfPixelLoc(-1)
+    , m_upHalfPixelLoc(-1)
+{
+}
+
+BloomPrograms::~BloomPrograms() {
+    destroy();
+}
+
+bool BloomPrograms::load(const std::string& shaderDir) {
+    ShaderProgram down(m_renderer->loadShader(shaderDir + "basic.vert", shaderDir + "bloom_down.frag"));
+    ShaderProgram up(m_renderer->loadShader(shaderDir + "basic.vert", shaderDir + "bloom_up.frag"));
+    if (!down.isValid() || !up.isValid()) return false;
+    
+    m_downShader = std::move(down);
+    m_upShader = std::move(up);
+    
+    const float identity[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    
+    for (const ShaderProgram* program : {&m_downShader, &m_upShader}) {
+        program->use();
+        glUniformMatrix4fv(program->uniform("projection"), 1, GL_FALSE, identity);
+        glUniform1i(program->uniform("screenTexture"), 0);
+    }
+    glUseProgram(0);
+    
+    m_downHalfPixelLoc = m_downShader.uniform("halfPixel");
+    m_upHalfPixelLoc = m_upShader.uniform("halfPixel");
+    return true;
+}
+
+void BloomPrograms::destroy() {
+    m_downShader.destroy();
+    m_upShader.destroy();
+}
+
+BloomChain::BloomChain(Renderer* renderer, const BloomPrograms* programs)
+    : m_renderer(renderer)
+    , m_programs(programs)
+    , m_sourceWidth(0)
+    , m_sourceHeight(0)
+{
+}
+
+BloomChain::~BloomChain() {
+    destroy();
+}
+
+void BloomChain::resize(int width, int height) {
+    destroy();
+    
+    m_sourceWidth = width;
+    m_sourceHeight = height;
+    
+    int levelWidth = width;
+    int levelHeight = height;
+    for (Level& level : m_levels) {
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+        
+        level.width = levelWidth;
+        level.height = levelHeight;
+        level.fbo = m_renderer->createFramebuffer(levelWidth, levelHeight, level.texture);
+        
+        // Taps near the border must not wrap around to the opposite edge
+        glBindTexture(GL_TEXTURE_2D, level.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void BloomChain::destroy() {
+    for (Level& level : m_levels) {
+        if (level.texture) glDeleteTextures(1, &level.texture);
+        if (level.fbo) glDeleteFramebuffers(1, &level.fbo);
+        level = Level{};
+    }
+}
+
+void BloomChain::drawPass(const Level& target, GLuint sourceTexture, int sourceWidth, int sourceHeight,
+                          const ShaderProgram& shader, GLint halfPixelLoc) {
+    m_renderer->bindFramebuffer(target.fbo, target.width, target.height);
+    
+    shader.use();
+    glUniform2f(halfPixelLoc, 0.5f / sourceWidth, 0.5f / sourceHeight);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sourceTexture);
+    m_renderer->renderFullscreenQuad();
+}
+
+GLuint BloomChain::process(GLuint sourceTexture) {
+    const ShaderProgram& down = m_programs->m_downShader;
+    const ShaderProgram& up = m_programs->m_upShader;
+    const GLint downHalfPixel = m_programs->m_downHalfPixelLoc;
+    const GLint upHalfPixel = m_programs->m_upHalfPixelLoc;
+    
+    // Downsample: full -> 1/2 -> 1/4 -> 1/8
+    drawPass(m_levels[0], sourceTexture, m_sourceWidth, m_sourceHeight, down, downHalfPixel);
+    for (int i = 1; i < LEVELS; i++) {
+        const Level& source = m_levels[i - 1];
+        drawPass(m_levels[i], source.texture, source.width, source.height, down, downHalfPixel);
+    }
+    
+    // Upsample back up the chain; each level's downsampled content has
+    // already been consumed, so it can be overwritten in place
+    for (int i = LEVELS - 1; i > 0; i--) {
+        const Level& source = m_levels[i];
+        drawPass(m_levels[i - 1], source.texture, source.width, source.height, up, upHalfPixel);
+    }
+    
+    m_renderer->unbindFramebuffer();
+    
+    return m_levels[0].texture;
+}
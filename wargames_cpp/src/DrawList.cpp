@@ -0,0 +1,155 @@
+#include "DrawList.hpp"
+#include <algorithm>
+
+bool ViewCull::isVisible(const Bounds& bounds, float marginPixels) const {
+    const float marginX = marginPixels * degreesPerPixelX;
+    const float marginY = marginPixels * degreesPerPixelY;
+    const Bounds grown{bounds.minX - marginX, bounds.minY - marginY,
+                       bounds.maxX + marginX, bounds.maxY + marginY};
+
+    for (int i = 0; i < rectCount; i++) {
+        if (grown.intersects(rects[i])) return true;
+    }
+    return false;
+}
+
+DrawList::LineBucket& DrawList::bucketForWidth(float width) {
+    for (auto& bucket : m_lineBuckets) {
+        if (bucket.width == width) {
+            return bucket;
+        }
+    }
+    m_lineBuckets.push_back({width, {}});
+    return m_lineBuckets.back();
+}
+
+DrawList::InstanceBucket& DrawList::instanceBucket(ShapeMesh mesh, ShapeAnimation animation, int glowLayers) {
+    for (auto& bucket : m_instanceBuckets) {
+        if (bucket.mesh == mesh && bucket.animation == animation && bucket.glowLayers == glowLayers) {
+            return bucket;
+        }
+    }
+    m_instanceBuckets.push_back({mesh, animation, glowLayers, {}});
+    return m_instanceBuckets.back();
+}
+
+DrawList::TrailBucket& DrawList::trailBucket(int glowLayers) {
+    for (auto& bucket : m_trailBuckets) {
+        if (bucket.glowLayers == glowLayers) {
+            return bucket;
+        }
+    }
+    m_trailBuckets.push_back({glowLayers, 0, {}});
+    return m_trailBuckets.back();
+}
+
+void DrawList::appendSegments(std::vector<LineVertex>& vertices, const Point* points, size_t count,
+                              const Color& color, float width, float glow) {
+    // Strips are unrolled into independent segments so every path in the
+    // same draw can share a single GL_LINES call. Growth stays geometric:
+    // reserving the exact size would reallocate on every later path.
+    const size_t needed = vertices.size() + (count - 1) * 2;
+    if (needed > vertices.capacity()) {
+        vertices.reserve(std::max(needed, 2 * vertices.capacity()));
+    }
+    for (size_t i = 1; i < count; i++) {
+        const Point& a = points[i - 1];
+        const Point& b = points[i];
+        vertices.push_back({a.x, a.y, color.r, color.g, color.b, color.a, width, glow});
+        vertices.push_back({b.x, b.y, color.r, color.g, color.b, color.a, width, glow});
+    }
+}
+
+void DrawList::submitLine(float x1, float y1, float x2, float y2, const Color& color, float width, int glowLayers) {
+    const Point points[2] = { Point(x1, y1), Point(x2, y2) };
+    submitPath(points, 2, color, width, glowLayers);
+}
+
+void DrawList::submitPath(const Point* points, size_t count, const Color& color, float width, int glowLayers) {
+    if (count < 2) return;
+
+    if (m_glowMode == GlowMode::Shader) {
+        // One expanded copy carries the whole glow profile
+        int layers = std::min(glowLayers, MAX_GLOW_LAYERS);
+        appendSegments(m_glowVertices, points, count, color, width, static_cast<float>(layers));
+    } else if (glowLayers > 0) {
+        // Draw multiple layers with decreasing alpha and increasing width
+        for (int i = glowLayers - 1; i >= 0; i--) {
+            float layerAlpha = (i == 0) ? 1.0f : 0.3f / glowLayers;
+            float layerWidth = 1.0f + (glowLayers - i) * 0.8f;
+
+            Color layerColor(color.r, color.g, color.b, color.a * layerAlpha);
+            appendSegments(bucketForWidth(layerWidth).vertices, points, count, layerColor, layerWidth, 0.0f);
+        }
+    } else {
+        appendSegments(bucketForWidth(width).vertices, points, count, color, width, 0.0f);
+    }
+}
+
+void DrawList::submitInstance(ShapeMesh mesh, const ShapeInstance& instance, int glowLayers, ShapeAnimation animation) {
+    instanceBucket(mesh, animation, glowLayers).instances.push_back(instance);
+}
+
+void DrawList::submitTrail(uint32_t offset, uint32_t count, const Color& color, int glowLayers) {
+    if (count < 2) return;
+
+    // Shader glow carries the layer count in the draw, so it is clamped like
+    // the per-vertex value of submitPath()
+    if (m_glowMode == GlowMode::Shader) glowLayers = std::min(glowLayers, MAX_GLOW_LAYERS);
+
+    TrailBucket& bucket = trailBucket(glowLayers);
+    bucket.maxCount = std::max(bucket.maxCount, count);
+    bucket.trails.push_back({offset, count, color.r, color.g, color.b, color.a});
+}
+
+void DrawList::submitTrailPoints(uint32_t offset, const Point* points, size_t count) {
+    if (count == 0) return;
+
+    const uint32_t start = static_cast<uint32_t>(m_trailPoints.size());
+    m_trailPoints.insert(m_trailPoints.end(), points, points + count);
+    m_trailUploads.push_back({offset, start, static_cast<uint32_t>(count)});
+}
+
+size_t DrawList::lineVertexCount() const {
+    size_t total = m_glowVertices.size();
+    for (const auto& bucket : m_lineBuckets) {
+        total += bucket.vertices.size();
+    }
+    return total;
+}
+
+size_t DrawList::instanceCount() const {
+    size_t total = 0;
+    for (const auto& bucket : m_instanceBuckets) {
+        total += bucket.instances.size();
+    }
+    return total;
+}
+
+size_t DrawList::trailCount() const {
+    size_t total = 0;
+    for (const auto& bucket : m_trailBuckets) {
+        total += bucket.trails.size();
+    }
+    return total;
+}
+
+void DrawList::clear() {
+    for (auto& bucket : m_lineBuckets) {
+        bucket.vertices.clear();
+    }
+    m_glowVertices.clear();
+    for (auto& bucket : m_instanceBuckets) {
+        bucket.instances.clear();
+    }
+    for (auto& bucket : m_trailBuckets) {
+        bucket.maxCount = 0;
+        bucket.trails.clear();
+    }
+    clearTrailUploads();
+}
+
+void DrawList::clearTrailUploads() {
+    m_trailUploads.clear();
+    m_trailPoints.clear();
+}
@@ -1,49 +1,57 @@
 #include "Explosion.hpp"
-#include <cmath>
-
-constexpr float Explosion::RING_DELAYS[NUM_RINGS];
 
 Explosion::Explosion(float x, float y, const Color& color)
     : m_x(x)
     , m_y(y)
     , m_color(color)
     , m_age(0.0f)
+    , m_prevAge(0.0f)
     , m_duration(2.5f)
 {
 }
 
+ExplosionPool::ExplosionPool(size_t initialCapacity) {
+    m_explosions.reserve(initialCapacity);
+}
+
+void ExplosionPool::spawn(float x, float y, const Color& color) {
+    m_explosions.emplace_back(x, y, color);
+}
+
+void ExplosionPool::update(float dt) {
+    // Walk backwards so swap-removal never skips a live explosion
+    for (size_t i = m_explosions.size(); i-- > 0; ) {
+        m_explosions[i].update(dt);
+        if (m_explosions[i].isFinished()) {
+            m_explosions[i] = m_explosions.back();
+            m_explosions.pop_back();
+        }
+    }
+}
+
+void ExplosionPool::draw(DrawList& list, float alpha) const {
+    for (const Explosion& explosion : m_explosions) {
+        explosion.draw(list, alpha);
+    }
+}
+
 void Explosion::update(float dt) {
+    m_prevAge = m_age;
     m_age += dt;
 }
 
-void Explosion::draw(Renderer* renderer) {
-    const float maxRadius = 50.0f;
-    const float ringDuration = m_duration - RING_DELAYS[NUM_RINGS - 1];
+void Explosion::draw(DrawList& list, float alpha) const {
+    // Outer ring reaches 50 px, plus its glow
+    if (!list.isVisible(Bounds{m_x, m_y, m_x, m_y}, 60.0f)) return;
     
-    // Draw each ring
-    for (int i = 0; i < NUM_RINGS; i++) {
-        float ringAge = m_age - RING_DELAYS[i];
-        if (ringAge < 0.0f) continue;
-        
-        float t = ringAge / ringDuration;
-        if (t > 1.0f) continue;
-        
-        // Expanding radius
-        float radius = t * maxRadius;
-        
-        // Fading alpha
-        float alpha = 1.0f - t;
-        
-        Color ringColor(m_color.r, m_color.g, m_color.b, alpha * m_color.a);
-        renderer->drawCircleWithGlow(m_x, m_y, radius, ringColor, 4);
-    }
+    // Ring expansion, fade and the central flash are evaluated in the
+    // instanced vertex shader from the explosion's age
+    const float age = m_prevAge + (m_age - m_prevAge) * alpha;
+    const ShapeInstance instance{m_x, m_y, 1.0f, age, m_color.r, m_color.g, m_color.b, m_color.a};
+    list.submitInstance(ShapeMesh::Circle, instance, 4, ShapeAnimation::ExplosionRings);
     
     // Central flash (brightest at start)
-    if (m_age < 0.5f) {
-        float flashAlpha = 1.0f - (m_age / 0.5f);
-        float flashRadius = 5.0f + m_age * 10.0f;
-        
-        Color flashColor(m_color.r, m_color.g, m_color.b, flashAlpha);
-        renderer->drawCircleWithGlow(m_x, m_y, flashRadius, flashColor, 5);
+    if (age < 0.5f) {
+        list.submitInstance(ShapeMesh::Circle, instance, 5, ShapeAnimation::ExplosionFlash);
     }
 }
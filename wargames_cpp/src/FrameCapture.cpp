@@ -0,0 +1,474 @@
+#include "FrameCapture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // A stored deflate block holds at most this many bytes
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+
+    // Longest a close() waits on one readback before retrying
+    constexpr GLuint64 CLOSE_WAIT_NS = 1000000000;
+
+    // Widest zero padding a PNG pattern may ask for
+    constexpr int MAX_FRAME_DIGITS = 20;
+
+    // Splits a PNG pattern around its single %d or %0Nd. The target comes
+    // from the command line, so it is never used as a printf format.
+    bool splitFramePattern(const std::string& pattern, std::string& prefix, std::string& suffix, int& digits) {
+        const size_t percent = pattern.find('%');
+        if (percent == std::string::npos) return false;
+
+        size_t end = percent + 1;
+        digits = 0;
+        if (end < pattern.size() && pattern[end] == '0') {
+            end++;
+            while (end < pattern.size() && pattern[end] >= '0' && pattern[end] <= '9') {
+                digits = digits * 10 + (pattern[end] - '0');
+                if (digits > MAX_FRAME_DIGITS) return false;
+                end++;
+            }
+            if (digits == 0) return false;
+        }
+        if (end >= pattern.size() || pattern[end] != 'd') return false;
+        if (pattern.find('%', end + 1) != std::string::npos) return false;
+
+        prefix = pattern.substr(0, percent);
+        suffix = pattern.substr(end + 1);
+        return true;
+    }
+
+    uint32_t crc32(const uint8_t* data, size_t length) {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> values = {};
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+            return values;
+        }();
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < length; i++) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    uint32_t adler32(const uint8_t* data, size_t length) {
+        // 5552 bytes is the most that can be summed before the modulo overflows
+        uint32_t a = 1;
+        uint32_t b = 0;
+        while (length > 0) {
+            const size_t run = std::min<size_t>(length, 5552);
+            for (size_t i = 0; i < run; i++) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += run;
+            length -= run;
+        }
+        return (b << 16) | a;
+    }
+
+    void putU32(std::vector<uint8_t>& out, uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void appendChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t length) {
+        putU32(out, static_cast<uint32_t>(length));
+        const size_t typeAt = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + length);
+        putU32(out, crc32(out.data() + typeAt, out.size() - typeAt));
+    }
+}
+
+FrameCapture::FrameCapture()
+    : m_format(Format::Y4M)
+    , m_file(nullptr)
+    , m_pipe(false)
+    , m_open(false)
+    , m_width(0)
+    , m_height(0)
+    , m_frameDigits(0)
+    , m_head(0)
+    , m_tail(0)
+    , m_inFlight(0)
+    , m_warnedSize(false)
+    , m_queue{}
+    , m_queueHead(0)
+    , m_queueCount(0)
+    , m_stopping(false)
+    , m_captured(0)
+    , m_written(0)
+    , m_dropped(0)
+    , m_frameNumber(0)
+    , m_failed(false)
+{
+}
+
+FrameCapture::~FrameCapture() {
+    close();
+}
+
+bool FrameCapture::open(const std::string& target, int width, int height, int fps) {
+    close();
+    if (width <= 0 || height <= 0) return false;
+
+    m_width = width;
+    m_height = height;
+    m_target = target;
+    m_pipe = false;
+
+    if (target.compare(0, 5, "pipe:") == 0) {
+        // An encoder that exits early then fails our writes instead of
+        // killing the process
+        std::signal(SIGPIPE, SIG_IGN);
+        m_format = Format::Y4M;
+        m_file = popen(target.c_str() + 5, "w");
+        m_pipe = true;
+    } else if (target.find('%') != std::string::npos) {
+        if (!splitFramePattern(target, m_pathPrefix, m_pathSuffix, m_frameDigits)) {
+            std::cerr << "Capture pattern " << target << " must hold exactly one %d or %0Nd for the frame number\n";
+            return false;
+        }
+        m_format = Format::PngSequence;
+    } else {
+        m_format = Format::Y4M;
+        m_file = std::fopen(target.c_str(), "wb");
+    }
+
+    if (m_format == Format::Y4M) {
+        if (!m_file) {
+            std::cerr << "Failed to open capture target " << target << "\n";
+            return false;
+        }
+        // Full-range BT.601, which is what C420jpeg declares
+        std::fprintf(m_file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, std::max(1, fps));
+    }
+
+    const size_t frameBytes = static_cast<size_t>(width) * height * 4;
+    for (Slot& slot : m_slots) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_frames.assign(FRAME_POOL, std::vector<uint8_t>(frameBytes));
+    m_freeFrames.clear();
+    for (int i = FRAME_POOL; i-- > 0; ) {
+        m_freeFrames.push_back(i);
+    }
+    m_queueHead = 0;
+    m_queueCount = 0;
+    m_head = 0;
+    m_tail = 0;
+    m_inFlight = 0;
+    m_warnedSize = false;
+    m_stopping = false;
+    m_captured = 0;
+    m_written = 0;
+    m_dropped = 0;
+    m_frameNumber = 0;
+    m_failed = false;
+
+    m_encoder = std::thread(&FrameCapture::encoderLoop, this);
+    m_open = true;
+    std::cout << "Capturing " << width << "x" << height << " to " << target << "\n";
+    return true;
+}
+
+void FrameCapture::close() {
+    if (!m_open) return;
+
+    collect(true);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_frameQueued.notify_one();
+    m_encoder.join();
+
+    for (Slot& slot : m_slots) {
+        if (slot.pbo) glDeleteBuffers(1, &slot.pbo);
+        slot = Slot{};
+    }
+    if (m_file) {
+        if (m_pipe) {
+            pclose(m_file);
+        } else {
+            std::fclose(m_file);
+        }
+        m_file = nullptr;
+    }
+    m_frames.clear();
+    m_freeFrames.clear();
+    m_open = false;
+}
+
+FrameCapture::Stats FrameCapture::stats() const {
+    Stats stats;
+    stats.captured = m_captured.load(std::memory_order_relaxed);
+    stats.written = m_written.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FrameCapture::capture(int framebufferWidth, int framebufferHeight) {
+    if (!m_open) return;
+
+    // Readbacks started on earlier frames are usually done by now
+    collect(false);
+
+    if (framebufferWidth != m_width || framebufferHeight != m_height) {
+        if (!m_warnedSize) {
+            std::cerr << "Window is no longer " << m_width << "x" << m_height
+                      << "; skipping capture frames until it is\n";
+            m_warnedSize = true;
+        }
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Every buffer still waits on the GPU; waiting here is the stall this
+    // class exists to avoid
+    if (m_inFlight == RING_SIZE) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // With a pack buffer bound, glReadPixels only queues the copy
+    Slot& slot = m_slots[m_head];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_head = (m_head + 1) % RING_SIZE;
+    m_inFlight++;
+    m_captured.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameCapture::collect(bool wait) {
+    // Fences signal in submission order, so the oldest readback decides
+    while (m_inFlight > 0) {
+        Slot& slot = m_slots[m_tail];
+        const GLenum status = wait
+            ? glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, CLOSE_WAIT_NS)
+            : glClientWaitSync(slot.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            if (wait) continue;
+            break;
+        }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        if (status == GL_WAIT_FAILED) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            handOff(slot, wait);
+        }
+        m_tail = (m_tail + 1) % RING_SIZE;
+        m_inFlight--;
+    }
+}
+
+void FrameCapture::handOff(Slot& slot, bool wait) {
+    int frame = -1;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (wait) m_frameFreed.wait(lock, [this] { return !m_freeFrames.empty(); });
+        if (m_freeFrames.empty()) {
+            // The encoder is behind; this frame is lost rather than waited for
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        frame = m_freeFrames.back();
+        m_freeFrames.pop_back();
+    }
+
+    std::vector<uint8_t>& pixels = m_frames[frame];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixels.size(), GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(pixels.data(), mapped, pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (mapped) {
+            m_queue[(m_queueHead + m_queueCount) % FRAME_POOL] = frame;
+            m_queueCount++;
+        } else {
+            m_freeFrames.push_back(frame);
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (mapped) m_frameQueued.notify_one();
+}
+
+void FrameCapture::encoderLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_frameQueued.wait(lock, [this] { return m_queueCount > 0 || m_stopping; });
+        // Stopping only ends the loop once every queued frame is written
+        if (m_queueCount == 0) return;
+
+        const int frame = m_queue[m_queueHead];
+        m_queueHead = (m_queueHead + 1) % FRAME_POOL;
+        m_queueCount--;
+        lock.unlock();
+
+        if (m_failed) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            const uint8_t* rgba = m_frames[frame].data();
+            const bool written = (m_format == Format::Y4M) ? writeY4mFrame(rgba) : writePng(rgba);
+            if (written) {
+                m_written.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::cerr << "Capture write to " << m_target << " failed; discarding further frames\n";
+                m_failed = true;
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        m_frameNumber++;
+
+        lock.lock();
+        m_freeFrames.push_back(frame);
+        m_frameFreed.notify_one();
+    }
+}
+
+bool FrameCapture::writeY4mFrame(const uint8_t* rgba) {
+    const int width = m_width;
+    const int height = m_height;
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    const size_t lumaBytes = static_cast<size_t>(width) * height;
+    const size_t chromaBytes = static_cast<size_t>(chromaWidth) * chromaHeight;
+    m_encoded.resize(lumaBytes + 2 * chromaBytes);
+
+    uint8_t* yPlane = m_encoded.data();
+    uint8_t* uPlane = yPlane + lumaBytes;
+    uint8_t* vPlane = uPlane + chromaBytes;
+
+    // GL rows run bottom-up; video rows run top-down
+    auto pixel = [&](int x, int y) { return rgba + (static_cast<size_t>(height - 1 - y) * width + x) * 4; };
+
+    for (int y = 0; y < height; y++) {
+        uint8_t* out = yPlane + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; x++) {
+            const uint8_t* p = pixel(x, y);
+            out[x] = static_cast<uint8_t>((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+
+    // Chroma is the average of each 2x2 block; the offset keeps the
+    // intermediate sums positive
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int y = cy * 2; y < std::min(cy * 2 + 2, height); y++) {
+                for (int x = cx * 2; x < std::min(cx * 2 + 2, width); x++) {
+                    const uint8_t* p = pixel(x, y);
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    n++;
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            const size_t at = static_cast<size_t>(cy) * chromaWidth + cx;
+            uPlane[at] = static_cast<uint8_t>(std::min(255, (-43 * r - 85 * g + 128 * b + 32896) >> 8));
+            vPlane[at] = static_cast<uint8_t>(std::min(255, (128 * r - 107 * g - 21 * b + 32896) >> 8));
+        }
+    }
+
+    std::fputs("FRAME\n", m_file);
+    std::fwrite(m_encoded.data(), 1, m_encoded.size(), m_file);
+    // A pipe feeds a live stream, so frames should not sit in our buffer
+    if (m_pipe) std::fflush(m_file);
+    return !std::ferror(m_file);
+}
+
+bool FrameCapture::writePng(const uint8_t* rgba) {
+    // Scanlines are RGB with filter type 0, top row first
+    const size_t rowBytes = static_cast<size_t>(m_width) * 3 + 1;
+    m_scanlines.resize(rowBytes * m_height);
+    for (int y = 0; y < m_height; y++) {
+        uint8_t* out = m_scanlines.data() + rowBytes * y;
+        const uint8_t* in = rgba + static_cast<size_t>(m_height - 1 - y) * m_width * 4;
+        *out++ = 0;
+        for (int x = 0; x < m_width; x++, in += 4) {
+            *out++ = in[0];
+            *out++ = in[1];
+            *out++ = in[2];
+        }
+    }
+
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    m_encoded.assign(SIGNATURE, SIGNATURE + 8);
+
+    const uint8_t header[13] = {
+        static_cast<uint8_t>(m_width >> 24), static_cast<uint8_t>(m_width >> 16),
+        static_cast<uint8_t>(m_width >> 8), static_cast<uint8_t>(m_width),
+        static_cast<uint8_t>(m_height >> 24), static_cast<uint8_t>(m_height >> 16),
+        static_cast<uint8_t>(m_height >> 8), static_cast<uint8_t>(m_height),
+        8, 2, 0, 0, 0   // 8-bit RGB, no interlace
+    };
+    appendChunk(m_encoded, "IHDR", header, sizeof(header));
+
+    // The image data goes into stored (uncompressed) deflate blocks: no
+    // zlib dependency, and the encoder thread keeps up at full frame rate.
+    // Compress the sequence afterwards if size matters.
+    const size_t lengthAt = m_encoded.size();
+    putU32(m_encoded, 0);
+    const size_t typeAt = m_encoded.size();
+    m_encoded.insert(m_encoded.end(), {'I', 'D', 'A', 'T', 0x78, 0x01});
+    for (size_t offset = 0; offset < m_scanlines.size(); offset += MAX_STORED_BLOCK) {
+        const size_t length = std::min(MAX_STORED_BLOCK, m_scanlines.size() - offset);
+        const bool last = offset + length == m_scanlines.size();
+        m_encoded.push_back(last ? 1 : 0);
+        m_encoded.push_back(static_cast<uint8_t>(length));
+        m_encoded.push_back(static_cast<uint8_t>(length >> 8));
+        m_encoded.push_back(static_cast<uint8_t>(~length));
+        m_encoded.push_back(static_cast<uint8_t>(~length >> 8));
+        m_encoded.insert(m_encoded.end(), m_scanlines.begin() + offset, m_scanlines.begin() + offset + length);
+    }
+    putU32(m_encoded, adler32(m_scanlines.data(), m_scanlines.size()));
+
+    const uint32_t dataLength = static_cast<uint32_t>(m_encoded.size() - typeAt - 4);
+    for (int i = 0; i < 4; i++) {
+        m_encoded[lengthAt + i] = static_cast<uint8_t>(dataLength >> (24 - 8 * i));
+    }
+    putU32(m_encoded, crc32(m_encoded.data() + typeAt, m_encoded.size() - typeAt));
+    appendChunk(m_encoded, "IEND", nullptr, 0);
+
+    char number[32];
+    const int length = std::snprintf(number, sizeof(number), "%0*llu", m_frameDigits,
+                                     static_cast<unsigned long long>(m_frameNumber));
+    m_path.assign(m_pathPrefix).append(number, length).append(m_pathSuffix);
+    FILE* file = std::fopen(m_path.c_str(), "wb");
+    if (!file) return false;
+    const bool written = std::fwrite(m_encoded.data(), 1, m_encoded.size(), file) == m_encoded.size();
+    return std::fclose(file) == 0 && written;
+}
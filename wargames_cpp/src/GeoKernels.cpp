@@ -0,0 +1,179 @@
+#include "GeoKernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GEO_KERNELS_SSE2 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX builds per function, chosen at run time, so the default -march keeps
+// working on older CPUs
+#define GEO_KERNELS_AVX 1
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GEO_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+    constexpr float HALF_WORLD = WORLD_WIDTH * 0.5f;
+
+    // The reference every vector path must match
+    void projectScalar(const double* lon, const double* lat, size_t first, size_t count, Point* out) {
+        for (size_t i = first; i < count; i++) {
+            out[i] = lonlat_to_world(lon[i], lat[i]);
+        }
+    }
+
+    size_t breaksScalar(const Point* points, size_t first, size_t count, uint32_t* breaks, size_t found) {
+        for (size_t i = first; i < count; i++) {
+            if (std::abs(points[i].x - points[i - 1].x) > HALF_WORLD) {
+                breaks[found++] = static_cast<uint32_t>(i);
+            }
+        }
+        return found;
+    }
+
+#if GEO_KERNELS_SSE2
+    void projectSse2(const double* lon, const double* lat, size_t count, Point* out) {
+        float* dst = reinterpret_cast<float*>(out);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 x = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(lon + i)),
+                                           _mm_cvtpd_ps(_mm_loadu_pd(lon + i + 2)));
+            const __m128 y = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(lat + i)),
+                                           _mm_cvtpd_ps(_mm_loadu_pd(lat + i + 2)));
+            _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(x, y));
+        }
+        projectScalar(lon, lat, i, count, out);
+    }
+
+    size_t breaksSse2(const Point* points, size_t count, uint32_t* breaks) {
+        // Subtracting the point array from itself shifted by one point gives
+        // dx in the even lanes; the odd lanes (dy) are masked off
+        const float* src = reinterpret_cast<const float*>(points);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 limit = _mm_set1_ps(HALF_WORLD);
+        size_t found = 0;
+        size_t i = 1;
+        for (; i + 2 <= count; i += 2) {
+            const __m128 d = _mm_sub_ps(_mm_loadu_ps(src + 2 * i), _mm_loadu_ps(src + 2 * i - 2));
+            const int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_and_ps(d, absMask), limit)) & 0x5;
+            if (mask == 0) continue;
+            if (mask & 0x1) breaks[found++] = static_cast<uint32_t>(i);
+            if (mask & 0x4) breaks[found++] = static_cast<uint32_t>(i + 1);
+        }
+        return breaksScalar(points, i, count, breaks, found);
+    }
+#endif
+
+#if GEO_KERNELS_AVX
+    __attribute__((target("avx")))
+    void projectAvx(const double* lon, const double* lat, size_t count, Point* out) {
+        float* dst = reinterpret_cast<float*>(out);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 x = _mm256_cvtpd_ps(_mm256_loadu_pd(lon + i));
+            const __m128 y = _mm256_cvtpd_ps(_mm256_loadu_pd(lat + i));
+            _mm256_storeu_ps(dst + 2 * i, _mm256_set_m128(_mm_unpackhi_ps(x, y), _mm_unpacklo_ps(x, y)));
+        }
+        projectScalar(lon, lat, i, count, out);
+    }
+
+    __attribute__((target("avx")))
+    size_t breaksAvx(const Point* points, size_t count, uint32_t* breaks) {
+        const float* src = reinterpret_cast<const float*>(points);
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        const __m256 limit = _mm256_set1_ps(HALF_WORLD);
+        size_t found = 0;
+        size_t i = 1;
+        for (; i + 4 <= count; i += 4) {
+            const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(src + 2 * i), _mm256_loadu_ps(src + 2 * i - 2));
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_and_ps(d, absMask), limit, _CMP_GT_OQ)) & 0x55;
+            while (mask) {
+                const int lane = __builtin_ctz(mask);
+                breaks[found++] = static_cast<uint32_t>(i + lane / 2);
+                mask &= mask - 1;
+            }
+        }
+        return breaksScalar(points, i, count, breaks, found);
+    }
+
+    bool hasAvx() {
+        static const bool supported = __builtin_cpu_supports("avx");
+        return supported;
+    }
+#endif
+
+#if GEO_KERNELS_NEON
+    void projectNeon(const double* lon, const double* lat, size_t count, Point* out) {
+        float* dst = reinterpret_cast<float*>(out);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            float32x4x2_t xy;
+            xy.val[0] = vcombine_f32(vcvt_f32_f64(vld1q_f64(lon + i)), vcvt_f32_f64(vld1q_f64(lon + i + 2)));
+            xy.val[1] = vcombine_f32(vcvt_f32_f64(vld1q_f64(lat + i)), vcvt_f32_f64(vld1q_f64(lat + i + 2)));
+            vst2q_f32(dst + 2 * i, xy);
+        }
+        projectScalar(lon, lat, i, count, out);
+    }
+
+    size_t breaksNeon(const Point* points, size_t count, uint32_t* breaks) {
+        // De-interleaving loads put four x values in one register
+        const float* src = reinterpret_cast<const float*>(points);
+        const float32x4_t limit = vdupq_n_f32(HALF_WORLD);
+        size_t found = 0;
+        size_t i = 1;
+        for (; i + 4 <= count; i += 4) {
+            const float32x4_t x = vld2q_f32(src + 2 * i).val[0];
+            const float32x4_t previous = vld2q_f32(src + 2 * i - 2).val[0];
+            const uint32x4_t jumps = vcgtq_f32(vabdq_f32(x, previous), limit);
+            if (vmaxvq_u32(jumps) == 0) continue;
+            found = breaksScalar(points, i, i + 4, breaks, found);
+        }
+        return breaksScalar(points, i, count, breaks, found);
+    }
+#endif
+}
+
+void GeoKernels::projectPoints(const double* lon, const double* lat, size_t count, Point* out) {
+#if GEO_KERNELS_AVX
+    if (hasAvx()) {
+        projectAvx(lon, lat, count, out);
+        return;
+    }
+#endif
+#if GEO_KERNELS_SSE2
+    projectSse2(lon, lat, count, out);
+#elif GEO_KERNELS_NEON
+    projectNeon(lon, lat, count, out);
+#else
+    projectScalar(lon, lat, 0, count, out);
+#endif
+}
+
+size_t GeoKernels::findAntimeridianBreaks(const Point* points, size_t count, uint32_t* breaks) {
+    if (count < 2) return 0;
+#if GEO_KERNELS_AVX
+    if (hasAvx()) return breaksAvx(points, count, breaks);
+#endif
+#if GEO_KERNELS_SSE2
+    return breaksSse2(points, count, breaks);
+#elif GEO_KERNELS_NEON
+    return breaksNeon(points, count, breaks);
+#else
+    return breaksScalar(points, 1, count, breaks, 0);
+#endif
+}
+
+const char* GeoKernels::instructionSet() {
+#if GEO_KERNELS_AVX
+    if (hasAvx()) return "AVX";
+#endif
+#if GEO_KERNELS_SSE2
+    return "SSE2";
+#elif GEO_KERNELS_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,83 @@
+#include "JobSystem.hpp"
+
+namespace {
+    // Queued jobs before the ring first doubles
+    constexpr size_t INITIAL_JOB_CAPACITY = 1024;
+}
+
+JobSystem::JobSystem(unsigned threadCount)
+    : m_jobs(INITIAL_JOB_CAPACITY) {
+    if (threadCount == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    
+    m_workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++) {
+        m_workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_jobCount == m_jobs.size()) {
+            // Unroll the ring into a buffer twice the size
+            std::vector<std::function<void()>> grown(m_jobs.size() * 2);
+            for (size_t i = 0; i < m_jobCount; i++) {
+                grown[i] = std::move(m_jobs[(m_jobHead + i) % m_jobs.size()]);
+            }
+            m_jobs.swap(grown);
+            m_jobHead = 0;
+        }
+        m_jobs[(m_jobHead + m_jobCount) % m_jobs.size()] = std::move(job);
+        m_jobCount++;
+    }
+    m_wake.notify_one();
+}
+
+void JobSystem::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_jobCount == 0 && m_running == 0; });
+}
+
+void JobSystem::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || m_jobCount > 0; });
+            
+            // Drain remaining jobs before exiting so waitIdle never hangs
+            if (m_jobCount == 0) return;
+            
+            job = std::move(m_jobs[m_jobHead]);
+            m_jobs[m_jobHead] = nullptr;
+            m_jobHead = (m_jobHead + 1) % m_jobs.size();
+            m_jobCount--;
+            m_running++;
+        }
+        
+        job();
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running--;
+            if (m_jobCount == 0 && m_running == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,220 @@
+#include "MissilePool.hpp"
+#include <algorithm>
+
+MissilePool::MissilePool(TrajectoryCache& trajectories, size_t initialCapacity)
+    : m_trajectories(trajectories) {
+    grow(initialCapacity > 0 ? initialCapacity : 1);
+}
+
+void MissilePool::grow(size_t newCapacity) {
+    const size_t oldCapacity = capacity();
+    
+    m_progress.resize(newCapacity, 0.0f);
+    m_prevProgress.resize(newCapacity, 0.0f);
+    m_duration.resize(newCapacity, 0.0f);
+    m_trailPoints.resize(newCapacity, 0);
+    m_colors.resize(newCapacity);
+    m_types.resize(newCapacity, MissileType::Silo);
+    m_basePos.resize(newCapacity);
+    m_paths.resize(newCapacity, TrajectoryCache::INVALID_HANDLE);
+    m_livePos.resize(newCapacity, 0);
+    m_live.reserve(newCapacity);
+    m_freeSlots.reserve(newCapacity);
+    m_pending.reserve(newCapacity);
+    m_readyPaths.reserve(newCapacity);
+    
+    // Push in reverse so the lowest slots are handed out first
+    for (size_t slot = newCapacity; slot-- > oldCapacity; ) {
+        m_freeSlots.push_back(static_cast<uint32_t>(slot));
+    }
+}
+
+void MissilePool::spawn(MissileType type, const LatLon& start, const LatLon& end, const Color& color) {
+    TrajectoryCache::Handle path = m_trajectories.tryAcquire(start, end, PATH_SAMPLES);
+    
+    if (path == TrajectoryCache::INVALID_HANDLE) {
+        if (m_trajectories.requestAsync(start, end, PATH_SAMPLES)) {
+            m_pending.push_back({type, start, end, color});
+            return;
+        }
+        path = m_trajectories.acquire(start, end, PATH_SAMPLES);
+    }
+    
+    launch(type, start, path, color);
+}
+
+void MissilePool::activatePending() {
+    if (m_pending.empty()) return;
+    
+    // Nothing new can be ready unless a worker finished since the last call
+    m_readyPaths.clear();
+    if (m_trajectories.collectCompleted(m_readyPaths) == 0) return;
+    
+    size_t kept = 0;
+    for (size_t i = 0; i < m_pending.size(); i++) {
+        const PendingLaunch& pending = m_pending[i];
+        TrajectoryCache::Handle path = m_trajectories.tryAcquire(pending.start, pending.end, PATH_SAMPLES);
+        
+        if (path != TrajectoryCache::INVALID_HANDLE) {
+            launch(pending.type, pending.start, path, pending.color);
+        } else {
+            m_pending[kept++] = pending;
+        }
+    }
+    m_pending.resize(kept);
+    
+    // Drop the references collectCompleted() handed us now that the
+    // launched missiles hold their own
+    for (TrajectoryCache::Handle path : m_readyPaths) {
+        m_trajectories.release(path);
+    }
+}
+
+void MissilePool::launch(MissileType type, const LatLon& start, TrajectoryCache::Handle path, const Color& color) {
+    if (m_freeSlots.empty()) {
+        grow(capacity() * 2);
+    }
+    
+    uint32_t slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    
+    m_progress[slot] = 0.0f;
+    m_prevProgress[slot] = 0.0f;
+    m_duration[slot] = 12.0f;
+    m_trailPoints[slot] = 0;
+    m_colors[slot] = color;
+    m_types[slot] = type;
+    m_basePos[slot] = lonlat_to_world(start.lon, start.lat);
+    m_paths[slot] = path;
+    
+    m_livePos[slot] = static_cast<uint32_t>(m_live.size());
+    m_live.push_back(slot);
+}
+
+void MissilePool::release(uint32_t slot) {
+    // Swap-remove from the dense live list
+    uint32_t pos = m_livePos[slot];
+    uint32_t last = m_live.back();
+    m_live[pos] = last;
+    m_livePos[last] = pos;
+    m_live.pop_back();
+    
+    m_trajectories.release(m_paths[slot]);
+    m_paths[slot] = TrajectoryCache::INVALID_HANDLE;
+    m_freeSlots.push_back(slot);
+}
+
+void MissilePool::update(float dt, std::vector<Point>& impacts) {
+    // Walk backwards so swap-removal never skips a live slot
+    for (size_t i = m_live.size(); i-- > 0; ) {
+        uint32_t slot = m_live[i];
+        m_prevProgress[slot] = m_progress[slot];
+        
+        float progress = m_progress[slot] + dt / m_duration[slot];
+        if (progress >= 1.0f) {
+            m_progress[slot] = 1.0f;
+            TrajectoryCache::Handle path = m_paths[slot];
+            impacts.push_back(m_trajectories.points(path)[m_trajectories.count(path) - 1]);
+            release(slot);
+        } else {
+            m_progress[slot] = progress;
+        }
+    }
+}
+
+void MissilePool::draw(DrawList& list, float alpha) const {
+    for (uint32_t slot : m_live) {
+        // The path bounds cover the launch site and target; the margin
+        // covers the icons, target pulse and glow
+        if (!list.isVisible(m_trajectories.bounds(m_paths[slot]), 20.0f)) continue;
+        
+        drawIcon(list, slot);
+        
+        const float progress = m_prevProgress[slot] + (m_progress[slot] - m_prevProgress[slot]) * alpha;
+        const int pathCount = static_cast<int>(m_trajectories.count(m_paths[slot]));
+        drawTrail(list, slot, 0, static_cast<int>(progress * pathCount));
+        drawTargetMarker(list, slot, progress);
+    }
+}
+
+void MissilePool::drawPersistent(DrawList& list, DrawList& trails, float alpha, bool redraw) {
+    for (uint32_t slot : m_live) {
+        const float progress = m_prevProgress[slot] + (m_progress[slot] - m_prevProgress[slot]) * alpha;
+        const int pathCount = static_cast<int>(m_trajectories.count(m_paths[slot]));
+        const int numPoints = static_cast<int>(progress * pathCount);
+        
+        // Off-screen trails are still marked drawn, so a missile flying into
+        // view does not dump its whole hidden trail at once
+        if (list.isVisible(m_trajectories.bounds(m_paths[slot]), 20.0f)) {
+            drawIcon(list, slot);
+            
+            // Start at the last point already drawn so the new segment joins it
+            const int drawn = redraw ? 0 : static_cast<int>(m_trailPoints[slot]);
+            drawTrail(trails, slot, std::max(drawn - 1, 0), numPoints);
+            drawTargetMarker(list, slot, progress);
+        }
+        m_trailPoints[slot] = static_cast<uint32_t>(std::max(numPoints, 0));
+    }
+}
+
+void MissilePool::drawGpu(DrawList& list, float alpha) const {
+    for (uint32_t slot : m_live) {
+        const TrajectoryCache::Handle path = m_paths[slot];
+        if (!list.isVisible(m_trajectories.bounds(path), 20.0f)) continue;
+        
+        drawIcon(list, slot);
+        
+        const float progress = m_prevProgress[slot] + (m_progress[slot] - m_prevProgress[slot]) * alpha;
+        const int numPoints = static_cast<int>(progress * m_trajectories.count(path));
+        if (numPoints >= 2) {
+            list.submitTrail(m_trajectories.offset(path), static_cast<uint32_t>(numPoints), m_colors[slot], 5);
+        }
+        drawTargetMarker(list, slot, progress);
+    }
+}
+
+void MissilePool::drawIcon(DrawList& list, uint32_t slot) const {
+    // Draw launch icon at the start position
+    const Point& base = m_basePos[slot];
+    const Color& color = m_colors[slot];
+    const ShapeInstance icon{base.x, base.y, 1.0f, 0.0f, color.r, color.g, color.b, color.a};
+    const ShapeMesh mesh = (m_types[slot] == MissileType::Silo)
+        ? ShapeMesh::SiloIcon : ShapeMesh::SubmarineIcon;
+    list.submitInstance(mesh, icon, 3);
+}
+
+void MissilePool::drawTrail(DrawList& list, uint32_t slot, int first, int numPoints) const {
+    // Draws path points [first, numPoints); numPoints follows the missile's progress
+    if (numPoints - first < 2) return;
+    
+    const Point* path = m_trajectories.points(m_paths[slot]);
+    const Color& color = m_colors[slot];
+    
+    // Split trail at antimeridian to avoid straight-line wrap artifacts.
+    // The break indices are fixed per path, so each run is drawn straight
+    // out of the cached samples.
+    const uint32_t* breaks = m_trajectories.breaks(m_paths[slot]);
+    const uint32_t breakCount = m_trajectories.breakCount(m_paths[slot]);
+    
+    int runStart = first;
+    for (uint32_t b = 0; b < breakCount && static_cast<int>(breaks[b]) < numPoints; b++) {
+        int runEnd = static_cast<int>(breaks[b]);
+        if (runEnd > runStart) {
+            list.submitPath(path + runStart, runEnd - runStart, color, 1.0f, 5);
+            runStart = runEnd;
+        }
+    }
+    list.submitPath(path + runStart, numPoints - runStart, color, 1.0f, 5);
+}
+
+void MissilePool::drawTargetMarker(DrawList& list, uint32_t slot, float progress) const {
+    // Draw pulsing target marker at 85% progress
+    if (progress >= 0.85f && progress < 1.0f) {
+        // Pulse radius and alpha are evaluated in the vertex shader
+        const Point* path = m_trajectories.points(m_paths[slot]);
+        const Point& targetPos = path[m_trajectories.count(m_paths[slot]) - 1];
+        const Color& color = m_colors[slot];
+        const ShapeInstance marker{targetPos.x, targetPos.y, 1.0f, progress, color.r, color.g, color.b, color.a};
+        list.submitInstance(ShapeMesh::Circle, marker, 3, ShapeAnimation::TargetPulse);
+    }
+}
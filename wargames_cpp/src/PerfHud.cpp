@@ -0,0 +1,134 @@
+#include "PerfHud.hpp"
+#include "AllocationCounter.hpp"
+#include <cctype>
+#include <cstdio>
+
+namespace {
+    // Stroke font on a 4 x 6 grid, y down. Each glyph is a list of
+    // polylines separated by spaces; every polyline is a run of "xy" digit
+    // pairs.
+    struct Glyph {
+        char c;
+        const char* strokes;
+    };
+
+    constexpr Glyph GLYPHS[] = {
+        {'0', "0040460600 0640"}, {'1', "102026 1636"}, {'2', "004043030646"},
+        {'3', "00404606 0343"}, {'4', "000343 4046"}, {'5', "400003434606"},
+        {'6', "400006464303"}, {'7', "004026"}, {'8', "0040460600 0343"},
+        {'9', "430300404606"},
+        {'A', "0602204246 0343"}, {'B', "06003041423303 3344453606"}, {'C', "40000646"},
+        {'D', "00304244360600"}, {'E', "40000646 0333"}, {'F', "400006 0333"},
+        {'G', "400006464323"}, {'H', "0006 4046 0343"}, {'I', "1030 2026 1636"},
+        {'J', "4045361605"}, {'K', "0006 400346"}, {'L', "000646"},
+        {'M', "0600234046"}, {'N', "06004640"}, {'O', "0040460600"},
+        {'P', "0600404303"}, {'Q', "0040460600 2446"}, {'R', "0600404303 2346"},
+        {'S', "400003434606"}, {'T', "0040 2026"}, {'U', "00064640"},
+        {'V', "002640"}, {'W', "0006234640"}, {'X', "0046 4006"},
+        {'Y', "0023 4023 2326"}, {'Z', "00400646"},
+        {'.', "2526"}, {':', "2122 2425"}, {'/', "4006"}, {'-', "0343"},
+        {'+', "0343 2125"}, {'=', "0242 0444"}, {'%', "4006 0111 3545"},
+        {'(', "301336"}, {')', "103316"}, {'_', "0646"},
+    };
+
+    const char* strokesFor(char c) {
+        const char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        for (const Glyph& glyph : GLYPHS) {
+            if (glyph.c == upper) return glyph.strokes;
+        }
+        return nullptr;
+    }
+
+    // Formats into an existing line, reusing its storage
+    template <typename... Args>
+    void formatLine(std::string& line, const char* format, Args... args) {
+        char buffer[128];
+        std::snprintf(buffer, sizeof(buffer), format, args...);
+        line.assign(buffer);
+    }
+}
+
+PerfHud::PerfHud(Renderer* renderer)
+    : m_renderer(renderer)
+{
+}
+
+void PerfHud::update(const Profiler::Report& report) {
+    using Section = Profiler::Section;
+    using Counter = Profiler::Counter;
+
+    // Lines keep their storage between updates, so a warm overlay
+    // allocates nothing
+    size_t used = 0;
+    auto nextLine = [&]() -> std::string& {
+        if (used == m_lines.size()) m_lines.emplace_back();
+        return m_lines[used++];
+    };
+
+    formatLine(nextLine(), "FPS %.1f  FRAME %.2f MS  MAX %.2f MS",
+               report.fps, report.frameMs, report.maxFrameMs);
+    nextLine().assign("SECTION     CPU MS  GPU MS");
+    for (int i = 0; i < Profiler::SECTION_COUNT; i++) {
+        const Section section = static_cast<Section>(i);
+        if (report.hasGpu[i]) {
+            formatLine(nextLine(), "%-10s %7.2f %7.2f", Profiler::sectionName(section),
+                       report.cpuMs[i], report.gpuMs[i]);
+        } else {
+            formatLine(nextLine(), "%-10s %7.2f       -", Profiler::sectionName(section),
+                       report.cpuMs[i]);
+        }
+    }
+    formatLine(nextLine(), "DRAW CALLS %.0f  UPLOAD %.1f KB",
+               report.counters[static_cast<int>(Counter::DrawCalls)],
+               report.counters[static_cast<int>(Counter::UploadBytes)] / 1024.0);
+    formatLine(nextLine(), "MISSILES %.0f  EXPLOSIONS %.0f  SIM %.2f MS",
+               report.counters[static_cast<int>(Counter::LiveMissiles)],
+               report.counters[static_cast<int>(Counter::Explosions)],
+               report.counters[static_cast<int>(Counter::SimulationMs)]);
+    if (AllocationCounter::isEnabled()) {
+        formatLine(nextLine(), "ALLOCATIONS %.1f PER FRAME",
+                   report.counters[static_cast<int>(Counter::Allocations)]);
+    }
+    m_lines.resize(used);
+}
+
+void PerfHud::draw() {
+    if (m_lines.empty()) return;
+
+    m_renderer->beginOverlay();
+    m_renderer->beginBatch();
+
+    float y = 16.0f;
+    for (const std::string& line : m_lines) {
+        drawText(line, 16.0f, y, Colors::CYAN);
+        y += LINE_HEIGHT;
+    }
+
+    m_renderer->flushBatch();
+    m_renderer->endOverlay();
+}
+
+void PerfHud::drawText(const std::string& text, float x, float y, const Color& color) {
+    for (char c : text) {
+        const char* strokes = strokesFor(c);
+        if (strokes) {
+            // Walk each polyline's digit pairs; a space starts a new one
+            const char* p = strokes;
+            while (*p) {
+                if (*p == ' ') {
+                    p++;
+                    continue;
+                }
+                Point previous(x + (p[0] - '0') * GLYPH_SCALE, y + (p[1] - '0') * GLYPH_SCALE);
+                p += 2;
+                while (*p && *p != ' ') {
+                    Point next(x + (p[0] - '0') * GLYPH_SCALE, y + (p[1] - '0') * GLYPH_SCALE);
+                    m_renderer->submitLine(previous.x, previous.y, next.x, next.y, color);
+                    previous = next;
+                    p += 2;
+                }
+            }
+        }
+        x += ADVANCE;
+    }
+}
@@ -0,0 +1,238 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+namespace {
+    const char* const SECTION_NAMES[Profiler::SECTION_COUNT] = {
+        "update", "trails", "scene", "map", "entities", "flush", "bloom", "composite", "capture", "hud", "present"
+    };
+
+    const char* const COUNTER_NAMES[Profiler::COUNTER_COUNT] = {
+        "draw_calls", "upload_bytes", "live_missiles", "explosions", "simulation_ms",
+        "allocations"
+    };
+
+    double millisecondsBetween(std::chrono::steady_clock::time_point from,
+                               std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    bool hasJsonExtension(const std::string& path) {
+        if (path.size() < 5) return false;
+        std::string extension = path.substr(path.size() - 5);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".json";
+    }
+}
+
+const char* Profiler::sectionName(Section section) {
+    return SECTION_NAMES[static_cast<int>(section)];
+}
+
+const char* Profiler::counterName(Counter counter) {
+    return COUNTER_NAMES[static_cast<int>(counter)];
+}
+
+Profiler::Profiler(double reportInterval)
+    : m_reportInterval(reportInterval)
+    , m_startTime(Clock::now())
+    , m_windowStart(m_startTime)
+    , m_frameStart(m_startTime)
+    , m_frameIndex(0)
+    , m_windowFrames(0)
+    , m_windowFrameMs(0.0)
+    , m_windowMaxFrameMs(0.0)
+    , m_gpuBusy(false)
+    , m_initialized(false)
+    , m_dumpJson(false)
+{
+}
+
+Profiler::~Profiler() {
+    // Query objects die with the context; only the dump needs closing
+    m_dump.close();
+}
+
+void Profiler::initialize() {
+    if (m_initialized) return;
+
+    for (SectionState& state : m_sections) {
+        glGenQueries(QUERY_FRAMES, state.queries);
+    }
+    m_initialized = true;
+}
+
+void Profiler::shutdown() {
+    if (!m_initialized) return;
+
+    for (SectionState& state : m_sections) {
+        glDeleteQueries(QUERY_FRAMES, state.queries);
+        std::fill(std::begin(state.queries), std::end(state.queries), 0);
+        std::fill(std::begin(state.issued), std::end(state.issued), false);
+    }
+    m_initialized = false;
+}
+
+void Profiler::beginFrame() {
+    m_frameStart = Clock::now();
+    m_frameIndex++;
+
+    for (SectionState& state : m_sections) {
+        state.frameCpuMs = 0.0;
+    }
+    std::fill(std::begin(m_frameCounters), std::end(m_frameCounters), 0.0);
+
+    if (m_initialized) harvestQueries();
+}
+
+void Profiler::harvestQueries() {
+    for (SectionState& state : m_sections) {
+        for (int slot = 0; slot < QUERY_FRAMES; slot++) {
+            if (!state.issued[slot]) continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(state.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(state.queries[slot], GL_QUERY_RESULT, &nanoseconds);
+            state.windowGpuMs += static_cast<double>(nanoseconds) * 1e-6;
+            state.gpuSamples++;
+            state.issued[slot] = false;
+        }
+    }
+}
+
+void Profiler::beginSection(Section section, bool gpu) {
+    SectionState& state = m_sections[static_cast<int>(section)];
+    state.start = Clock::now();
+
+    // A slot still pending after QUERY_FRAMES frames is overwritten and
+    // its sample dropped rather than waited on
+    if (gpu && m_initialized && !m_gpuBusy) {
+        const int slot = static_cast<int>(m_frameIndex % QUERY_FRAMES);
+        glBeginQuery(GL_TIME_ELAPSED, state.queries[slot]);
+        state.issued[slot] = true;
+        state.gpuOpen = true;
+        m_gpuBusy = true;
+    }
+}
+
+void Profiler::endSection(Section section) {
+    SectionState& state = m_sections[static_cast<int>(section)];
+    state.frameCpuMs += millisecondsBetween(state.start, Clock::now());
+
+    if (state.gpuOpen) {
+        glEndQuery(GL_TIME_ELAPSED);
+        state.gpuOpen = false;
+        m_gpuBusy = false;
+    }
+}
+
+void Profiler::setCounter(Counter counter, double value) {
+    m_frameCounters[static_cast<int>(counter)] = value;
+}
+
+bool Profiler::endFrame() {
+    const Clock::time_point now = Clock::now();
+    const double frameMs = millisecondsBetween(m_frameStart, now);
+
+    m_windowFrames++;
+    m_windowFrameMs += frameMs;
+    m_windowMaxFrameMs = std::max(m_windowMaxFrameMs, frameMs);
+    for (SectionState& state : m_sections) {
+        state.windowCpuMs += state.frameCpuMs;
+    }
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        m_windowCounters[i] += m_frameCounters[i];
+    }
+
+    const double windowSeconds = millisecondsBetween(m_windowStart, now) * 1e-3;
+    if (windowSeconds < m_reportInterval) return false;
+
+    const double frames = static_cast<double>(m_windowFrames);
+    m_report.seconds = millisecondsBetween(m_startTime, now) * 1e-3;
+    m_report.frames = m_windowFrames;
+    m_report.fps = frames / windowSeconds;
+    m_report.frameMs = m_windowFrameMs / frames;
+    m_report.maxFrameMs = m_windowMaxFrameMs;
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        SectionState& state = m_sections[i];
+        m_report.cpuMs[i] = state.windowCpuMs / frames;
+        m_report.hasGpu[i] = state.gpuSamples > 0;
+        m_report.gpuMs[i] = state.gpuSamples > 0 ? state.windowGpuMs / state.gpuSamples : 0.0;
+        state.windowCpuMs = 0.0;
+        state.windowGpuMs = 0.0;
+        state.gpuSamples = 0;
+    }
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        m_report.counters[i] = m_windowCounters[i] / frames;
+        m_windowCounters[i] = 0.0;
+    }
+
+    m_windowStart = now;
+    m_windowFrames = 0;
+    m_windowFrameMs = 0.0;
+    m_windowMaxFrameMs = 0.0;
+
+    if (m_dump.is_open()) writeDump();
+    return true;
+}
+
+bool Profiler::openDump(const std::string& path) {
+    m_dump.open(path, std::ios::out | std::ios::trunc);
+    if (!m_dump) {
+        std::cerr << "Cannot open profile output: " << path << "\n";
+        return false;
+    }
+
+    m_dumpJson = hasJsonExtension(path);
+    if (!m_dumpJson) {
+        m_dump << "time_s,frames,fps,frame_ms,max_frame_ms";
+        for (const char* name : SECTION_NAMES) m_dump << ",cpu_" << name << "_ms";
+        for (const char* name : SECTION_NAMES) m_dump << ",gpu_" << name << "_ms";
+        for (const char* name : COUNTER_NAMES) m_dump << "," << name;
+        m_dump << "\n";
+    }
+    return true;
+}
+
+void Profiler::writeDump() {
+    const Report& r = m_report;
+
+    if (m_dumpJson) {
+        // One object per line so the file can be tailed and streamed
+        m_dump << "{\"time_s\":" << r.seconds << ",\"frames\":" << r.frames
+               << ",\"fps\":" << r.fps << ",\"frame_ms\":" << r.frameMs
+               << ",\"max_frame_ms\":" << r.maxFrameMs << ",\"cpu_ms\":{";
+        for (int i = 0; i < SECTION_COUNT; i++) {
+            m_dump << (i ? "," : "") << "\"" << SECTION_NAMES[i] << "\":" << r.cpuMs[i];
+        }
+        m_dump << "},\"gpu_ms\":{";
+        bool first = true;
+        for (int i = 0; i < SECTION_COUNT; i++) {
+            if (!r.hasGpu[i]) continue;
+            m_dump << (first ? "" : ",") << "\"" << SECTION_NAMES[i] << "\":" << r.gpuMs[i];
+            first = false;
+        }
+        m_dump << "},\"counters\":{";
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            m_dump << (i ? "," : "") << "\"" << COUNTER_NAMES[i] << "\":" << r.counters[i];
+        }
+        m_dump << "}}\n";
+    } else {
+        m_dump << r.seconds << "," << r.frames << "," << r.fps << "," << r.frameMs << "," << r.maxFrameMs;
+        for (int i = 0; i < SECTION_COUNT; i++) m_dump << "," << r.cpuMs[i];
+        for (int i = 0; i < SECTION_COUNT; i++) {
+            m_dump << ",";
+            if (r.hasGpu[i]) m_dump << r.gpuMs[i];
+        }
+        for (int i = 0; i < COUNTER_COUNT; i++) m_dump << "," << r.counters[i];
+        m_dump << "\n";
+    }
+
+    // Monitoring may read the file while the program runs
+    m_dump.flush();
+}
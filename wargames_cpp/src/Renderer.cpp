@@ -3,15 +3,298 @@
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Initial size of the streaming line buffer; grows on demand
+    constexpr size_t INITIAL_BATCH_BYTES = 1 << 20;
+    
+    // Widest glow supported by the shader path (matches the layer loops)
+    constexpr int MAX_GLOW_LAYERS = DrawList::MAX_GLOW_LAYERS;
+    
+    // Initial size of the per-frame instance buffer; grows on demand
+    constexpr size_t INITIAL_INSTANCE_BYTES = 64 * 1024;
+    
+    // Rings per explosion; each explosion instance is repeated this many
+    // times through the attribute divisor
+    constexpr GLuint EXPLOSION_RINGS = 4;
+    
+    // Initial sizes of the GPU trajectory buffer, in points, and of the
+    // per-frame trail instance buffer; both grow on demand
+    constexpr size_t INITIAL_TRAIL_POINTS = 256 * 1024;
+    constexpr size_t INITIAL_TRAIL_INSTANCE_BYTES = 64 * 1024;
+    
+    // Trajectory points are RG32F texels
+    static_assert(sizeof(Point) == 2 * sizeof(float), "Point must match the trail texel format");
+    
+    const char* LINE_VERTEX_SHADER = R"(
+        #version 330 core
+        layout (location = 0) in vec2 aPos;
+        layout (location = 1) in vec4 aColor;
+        layout (location = 2) in vec2 aStyle;
+        uniform mat4 projection;
+        uniform float wrapOffset;
+        out vec4 vColor;
+        out vec2 vStyle;
+        void main() {
+            gl_Position = projection * vec4(aPos.x + wrapOffset, aPos.y, 0.0, 1.0);
+            vColor = aColor;
+            vStyle = aStyle;
+        }
+    )";
+    
+    // Places a mesh vertex for one instance and evaluates the explosion and
+    // target-pulse animations that used to be computed per circle on the CPU.
+    // Hidden instances are moved outside the clip volume. Explosion timing
+    // matches Explosion: 2.5 s lifetime, rings launched 0.3 s apart.
+    const char* INSTANCE_VERTEX_SHADER = R"(
+        #version 330 core
+        layout (location = 0) in vec2 aOffset;
+        layout (location = 1) in vec4 aInstance;
+        layout (location = 2) in vec4 aColor;
+        uniform mat4 projection;
+        uniform int animation;
+        uniform vec2 style;
+        uniform float alphaScale;
+        uniform vec2 pixelToClip;
+        uniform float wrapOffset;
+        out vec4 vColor;
+        out vec2 vStyle;
+        
+        const int ANIM_EXPLOSION_RINGS = 1;
+        const int ANIM_EXPLOSION_FLASH = 2;
+        const int ANIM_TARGET_PULSE = 3;
+        
+        const int EXPLOSION_RINGS = 4;
+        const float EXPLOSION_DURATION = 2.5;
+        const float RING_SPACING = 0.3;
+        const float RING_MAX_RADIUS = 50.0;
+        const float FLASH_DURATION = 0.5;
+        
+        void main() {
+            vec2 center = aInstance.xy;
+            float scale = aInstance.z;
+            float age = aInstance.w;
+            vec4 color = aColor;
+            bool visible = true;
+            
+            if (animation == ANIM_EXPLOSION_RINGS) {
+                float ring = float(gl_InstanceID % EXPLOSION_RINGS);
+                float ringDuration = EXPLOSION_DURATION - RING_SPACING * float(EXPLOSION_RINGS - 1);
+                float t = (age - ring * RING_SPACING) / ringDuration;
+                visible = t >= 0.0 && t <= 1.0;
+                scale = t * RING_MAX_RADIUS;
+                color.a *= 1.0 - t;
+            } else if (animation == ANIM_EXPLOSION_FLASH) {
+                visible = age < FLASH_DURATION;
+                scale = 5.0 + age * 10.0;
+                color.a *= 1.0 - age / FLASH_DURATION;
+            } else if (animation == ANIM_TARGET_PULSE) {
+                float pulse = 0.5 + 0.5 * sin(age * 20.0);
+                scale = 10.0 + pulse * 5.0;
+                color.a = 0.5 + pulse * 0.5;
+            }
+            
+            vColor = vec4(color.rgb, color.a * alphaScale);
+            vStyle = style;
+            // Mesh offsets are reference pixels with y down, applied in clip space
+            vec4 origin = projection * vec4(center.x + wrapOffset, center.y, 0.0, 1.0);
+            gl_Position = visible ? origin + vec4(aOffset * scale * pixelToClip * origin.w, 0.0, 0.0)
+                                  : vec4(0.0, 0.0, 2.0, 1.0);
+        }
+    )";
+    
+    // Builds one trail segment per vertex pair from the trajectory buffer:
+    // segment i of an instance joins points i and i + 1 of its path. The
+    // draw covers the longest trail in the bucket, so segments past a
+    // missile, and the one that jumps across the antimeridian (the break
+    // rule of TrajectoryCache), collapse outside the clip volume.
+    // HALF_WORLD_WIDTH is defined by trailVertexSource().
+    const char* TRAIL_VERTEX_SHADER = R"(
+        #version 330 core
+        layout (location = 0) in uvec2 aTrail;
+        layout (location = 1) in vec4 aColor;
+        uniform samplerBuffer trailPoints;
+        uniform mat4 projection;
+        uniform vec2 style;
+        uniform float alphaScale;
+        uniform float wrapOffset;
+        out vec4 vColor;
+        out vec2 vStyle;
+        
+        void main() {
+            int segment = gl_VertexID / 2;
+            int first = int(aTrail.x);
+            int count = int(aTrail.y);
+            
+            vec2 a = texelFetch(trailPoints, first + segment).xy;
+            vec2 b = texelFetch(trailPoints, first + min(segment + 1, count - 1)).xy;
+            bool visible = segment + 1 < count && abs(b.x - a.x) <= HALF_WORLD_WIDTH;
+            vec2 p = (gl_VertexID % 2 == 0) ? a : b;
+            
+            vColor = vec4(aColor.rgb, aColor.a * alphaScale);
+            vStyle = style;
+            gl_Position = visible ? projection * vec4(p.x + wrapOffset, p.y, 0.0, 1.0)
+                                  : vec4(0.0, 0.0, 2.0, 1.0);
+        }
+    )";
+    
+    const char* LINE_FRAGMENT_SHADER = R"(
+        #version 330 core
+        in vec4 vColor;
+        out vec4 FragColor;
+        void main() {
+            FragColor = vColor;
+        }
+    )";
+    
+    // Expands each line into a screen-space quad wide enough for the
+    // outermost glow layer; the distance across the line, in reference
+    // pixels, drives the falloff
+    const char* GLOW_GEOMETRY_SHADER = R"(
+        #version 330 core
+        layout (lines) in;
+        layout (triangle_strip, max_vertices = 4) out;
+        in vec4 vColor[];
+        in vec2 vStyle[];
+        uniform vec2 viewport;
+        uniform float pixelScale;
+        out vec4 gColor;
+        out float gDistance;
+        flat out vec2 gStyle;
+        
+        void main() {
+            vec4 c0 = gl_in[0].gl_Position;
+            vec4 c1 = gl_in[1].gl_Position;
+            vec2 p0 = c0.xy / c0.w * 0.5 * viewport;
+            vec2 p1 = c1.xy / c1.w * 0.5 * viewport;
+            
+            vec2 dir = p1 - p0;
+            float len = length(dir);
+            if (len < 1e-4) return;
+            vec2 normal = vec2(-dir.y, dir.x) / len;
+            
+            float width = vStyle[0].x;
+            float layers = vStyle[0].y;
+            float extent = 0.5 * max(width, 1.0 + layers * 0.8) + 1.0;
+            vec2 offset = normal * extent * pixelScale / (0.5 * viewport);
+            
+            // Outputs are undefined after EmitVertex, so set all of them each time
+            gColor = vColor[0];
+            gStyle = vStyle[0];
+            gDistance = extent;
+            gl_Position = vec4(c0.xy + offset * c0.w, c0.zw);
+            EmitVertex();
+            gColor = vColor[0];
+            gStyle = vStyle[0];
+            gDistance = -extent;
+            gl_Position = vec4(c0.xy - offset * c0.w, c0.zw);
+            EmitVertex();
+            
+            gColor = vColor[1];
+            gStyle = vStyle[0];
+            gDistance = extent;
+            gl_Position = vec4(c1.xy + offset * c1.w, c1.zw);
+            EmitVertex();
+            gColor = vColor[1];
+            gStyle = vStyle[0];
+            gDistance = -extent;
+            gl_Position = vec4(c1.xy - offset * c1.w, c1.zw);
+            EmitVertex();
+            
+            EndPrimitive();
+        }
+    )";
+    
+    // Reproduces the sum of the layered glow passes analytically: layer i of
+    // N is 1 + (N - i) * 0.8 pixels wide with alpha 1 for i == 0 and 0.3 / N
+    // otherwise. Each layer contributes full rgb under additive blending.
+    const char* GLOW_FRAGMENT_SHADER = R"(
+        #version 330 core
+        in vec4 gColor;
+        in float gDistance;
+        flat in vec2 gStyle;
+        out vec4 FragColor;
+        
+        float coverage(float width, float d) {
+            return clamp(0.5 * width - d + 0.5, 0.0, 1.0);
+        }
+        
+        void main() {
+            float d = abs(gDistance);
+            float width = gStyle.x;
+            int layers = int(gStyle.y + 0.5);
+            
+            float rgbWeight;
+            float alphaWeight;
+            if (layers <= 0) {
+                rgbWeight = coverage(width, d);
+                alphaWeight = rgbWeight;
+            } else {
+                float n = float(layers);
+                rgbWeight = coverage(1.0 + n * 0.8, d);
+                alphaWeight = rgbWeight;
+                for (int i = 1; i < layers; i++) {
+                    float c = coverage(1.0 + (n - float(i)) * 0.8, d);
+                    rgbWeight += c;
+                    alphaWeight += c * 0.3 / n;
+                }
+            }
+            
+            if (rgbWeight <= 0.0) discard;
+            FragColor = vec4(gColor.rgb * rgbWeight, gColor.a * alphaWeight);
+        }
+    )";
+    
+    // The trail shader with its wrap threshold taken from WORLD_WIDTH, so
+    // the GPU splits paths where TrajectoryCache::analyzePath does
+    std::string trailVertexSource() {
+        std::string source = TRAIL_VERTEX_SHADER;
+        std::ostringstream define;
+        define << "\n        #define HALF_WORLD_WIDTH " << std::fixed << WORLD_WIDTH * 0.5f;
+        source.insert(source.find('\n', source.find("#version")), define.str());
+        return source;
+    }
+}
 
 Renderer::Renderer(int width, int height)
     : m_width(width)
     , m_height(height)
     , m_window(nullptr)
+    , m_currentWindow(nullptr)
     , m_glContext(nullptr)
+    , m_vsyncActive(false)
+    , m_swapInterval(0)
     , m_vao(0)
     , m_vbo(0)
-    , m_basicShader(0)
+    , m_vboCapacity(0)
+    , m_vboOffset(0)
+    , m_batching(false)
+    , m_glowMode(GlowMode::Layered)
+    , m_meshVao(0)
+    , m_meshVbo(0)
+    , m_instanceVbo(0)
+    , m_instanceCapacity(0)
+    , m_meshes()
+    , m_trailVao(0)
+    , m_trailInstanceVbo(0)
+    , m_trailInstanceCapacity(0)
+    , m_trailPointBuffer(0)
+    , m_trailPointTexture(0)
+    , m_trailPointCapacity(0)
+    , m_trailPointLimit(0)
+    , m_warnedTrailLimit(false)
+    , m_viewportWidth(width)
+    , m_viewportHeight(height)
+    , m_pixelScale(1.0f)
+    , m_wrapFirst(0)
+    , m_wrapCount(1)
+    , m_cull()
+    , m_viewCull()
+    , m_stats()
     , m_quadVao(0)
     , m_quadVbo(0)
     , m_quadEbo(0)
@@ -23,7 +306,7 @@ Renderer::~Renderer() {
     shutdown();
 }
 
-bool Renderer::initialize() {
+bool Renderer::initialize(const WindowSettings& settings) {
     // Set OpenGL attributes
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
@@ -37,7 +320,8 @@ bool Renderer::initialize() {
         SDL_WINDOWPOS_CENTERED,
         m_width,
         m_height,
-        SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN
+        SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI |
+        (settings.hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
     );
     
     if (!m_window) {
@@ -51,9 +335,11 @@ bool Renderer::initialize() {
         std::cerr << "Failed to create OpenGL context: " << SDL_GetError() << "\n";
         return false;
     }
+    m_currentWindow = m_window;
     
-    // Enable vsync
-    SDL_GL_SetSwapInterval(1);
+    // Benchmarks run unthrottled. Without vsync the application paces frames itself.
+    m_vsyncActive = SDL_GL_SetSwapInterval(settings.vsync ? 1 : 0) == 0 && settings.vsync;
+    m_swapInterval = m_vsyncActive ? 1 : 0;
     
     // Initialize GLAD
     if (!gladLoadGL((GLADloadfunc)SDL_GL_GetProcAddress)) {
@@ -64,6 +350,11 @@ bool Renderer::initialize() {
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << "\n";
     std::cout << "GLSL Version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << "\n";
     
+    m_shaderCache.initialize(settings.shaderCacheDir);
+    
+    // High-DPI displays give a drawable larger than the requested window
+    SDL_GL_GetDrawableSize(m_window, &m_width, &m_height);
+    
     setupGL();
     
     m_initialized = true;
@@ -71,9 +362,6 @@ bool Renderer::initialize() {
 }
 
 void Renderer::setupGL() {
-    // Set viewport
-    glViewport(0, 0, m_width, m_height);
-    
     // Enable blending
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -85,81 +373,92 @@ void Renderer::setupGL() {
     glBindVertexArray(m_vao);
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
     
-    // Position attribute
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    // Streaming buffer, orphaned whenever the write offset wraps
+    m_vboCapacity = INITIAL_BATCH_BYTES;
+    m_vboOffset = 0;
+    glBufferData(GL_ARRAY_BUFFER, m_vboCapacity, nullptr, GL_STREAM_DRAW);
+    
+    // Position, color and style (width, glow layers) attributes
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void*)offsetof(LineVertex, x));
     glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void*)offsetof(LineVertex, r));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void*)offsetof(LineVertex, width));
+    glEnableVertexAttribArray(2);
     
     glBindVertexArray(0);
 
     setupScreenQuad();
+    setupMeshes();
+    setupTrails();
     
-    // Load basic shader (we'll create a simple one inline for now)
-    const char* vertexShaderSource = R"(
-        #version 330 core
-        layout (location = 0) in vec2 aPos;
-        uniform mat4 projection;
-        void main() {
-            gl_Position = projection * vec4(aPos, 0.0, 1.0);
-        }
-    )";
-    
-    const char* fragmentShaderSource = R"(
-        #version 330 core
-        out vec4 FragColor;
-        uniform vec4 color;
-        void main() {
-            FragColor = color;
-        }
-    )";
+    // Line shaders are internal to the renderer, so they live inline
+    m_basicShader = ShaderProgram(buildProgram(LINE_VERTEX_SHADER, nullptr, LINE_FRAGMENT_SHADER));
+    m_glowShader = ShaderProgram(buildProgram(LINE_VERTEX_SHADER, GLOW_GEOMETRY_SHADER, GLOW_FRAGMENT_SHADER));
+    m_instanceShader = ShaderProgram(buildProgram(INSTANCE_VERTEX_SHADER, nullptr, LINE_FRAGMENT_SHADER));
+    m_instanceGlowShader = ShaderProgram(buildProgram(INSTANCE_VERTEX_SHADER, GLOW_GEOMETRY_SHADER, GLOW_FRAGMENT_SHADER));
+    const std::string trailVertexShader = trailVertexSource();
+    m_trailShader = ShaderProgram(buildProgram(trailVertexShader.c_str(), nullptr, LINE_FRAGMENT_SHADER));
+    m_trailGlowShader = ShaderProgram(buildProgram(trailVertexShader.c_str(), GLOW_GEOMETRY_SHADER, GLOW_FRAGMENT_SHADER));
     
-    // Compile vertex shader
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
+    cacheUniforms(m_basicShader, m_basicUniforms);
+    cacheUniforms(m_glowShader, m_glowUniforms);
+    cacheUniforms(m_instanceShader, m_instanceUniforms);
+    cacheUniforms(m_instanceGlowShader, m_instanceGlowUniforms);
+    cacheUniforms(m_trailShader, m_trailUniforms);
+    cacheUniforms(m_trailGlowShader, m_trailGlowUniforms);
     
-    // Check for errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "Vertex shader compilation failed:\n" << infoLog << "\n";
+    // The trajectory buffer is always read through texture unit 0
+    for (const ShaderProgram* program : {&m_trailShader, &m_trailGlowShader}) {
+        if (!program->isValid()) continue;
+        program->use();
+        glUniform1i(program->uniform("trailPoints"), 0);
     }
     
-    // Compile fragment shader
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
+    // Force the size-dependent uniforms to be written
+    m_viewportWidth = 0;
+    m_viewportHeight = 0;
+    setViewport(m_width, m_height);
+    setView(m_view);
+}
+
+void Renderer::cacheUniforms(const ShaderProgram& program, ProgramUniforms& uniforms) {
+    uniforms = ProgramUniforms{};
+    if (!program.isValid()) return;
     
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "Fragment shader compilation failed:\n" << infoLog << "\n";
-    }
+    uniforms.animation = program.uniform("animation");
+    uniforms.style = program.uniform("style");
+    uniforms.alphaScale = program.uniform("alphaScale");
+    uniforms.viewport = program.uniform("viewport");
+    uniforms.pixelScale = program.uniform("pixelScale");
+    uniforms.pixelToClip = program.uniform("pixelToClip");
+    uniforms.projection = program.uniform("projection");
+    uniforms.wrapOffset = program.uniform("wrapOffset");
+}
+
+void Renderer::setView(const MapView& view) {
+    // Queued geometry was submitted under the previous view
+    drawBatch();
     
-    // Link shader program
-    m_basicShader = glCreateProgram();
-    glAttachShader(m_basicShader, vertexShader);
-    glAttachShader(m_basicShader, fragmentShader);
-    glLinkProgram(m_basicShader);
+    m_view = view;
+    m_view.zoom = std::max(view.zoom, 1.0f);
     
-    glGetProgramiv(m_basicShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(m_basicShader, 512, NULL, infoLog);
-        std::cerr << "Shader linking failed:\n" << infoLog << "\n";
-    }
+    // Keep the poles inside the view and the center on the principal copy
+    const float halfWidth = WORLD_WIDTH * 0.5f / m_view.zoom;
+    const float halfHeight = WORLD_HEIGHT * 0.5f / m_view.zoom;
+    const float maxLat = WORLD_HEIGHT * 0.5f - halfHeight;
+    m_view.centerLat = std::clamp(m_view.centerLat, -maxLat, maxLat);
+    m_view.centerLon -= WORLD_WIDTH * std::floor((m_view.centerLon + WORLD_WIDTH * 0.5f) / WORLD_WIDTH);
     
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // Lists recorded for this view may be drawn under any of its tiles
+    setCullRects(m_viewCull, m_view.centerLon - halfWidth, m_view.centerLon + halfWidth,
+                 m_view.centerLat - halfHeight, m_view.centerLat + halfHeight);
     
-    // Set up orthographic projection
-    glUseProgram(m_basicShader);
-    
-    // Create orthographic projection matrix
-    float left = 0.0f;
-    float right = static_cast<float>(m_width);
-    float bottom = static_cast<float>(m_height);
-    float top = 0.0f;
+    // Orthographic projection of the tile's lon/lat window, bottom to top
+    float left = m_view.centerLon - halfWidth + 2.0f * halfWidth * m_tile.x;
+    float right = left + 2.0f * halfWidth * m_tile.width;
+    float top = m_view.centerLat + halfHeight - 2.0f * halfHeight * m_tile.y;
+    float bottom = top - 2.0f * halfHeight * m_tile.height;
     float near = -1.0f;
     float far = 1.0f;
     
@@ -170,13 +469,318 @@ void Renderer::setupGL() {
         -(right + left) / (right - left), -(top + bottom) / (top - bottom), -(far + near) / (far - near), 1.0f
     };
     
-    GLint projLoc = glGetUniformLocation(m_basicShader, "projection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, ortho);
+    // World copy k spans [-180, 180] + k * 360; draw every copy that
+    // overlaps the visible longitudes
+    const float worldMin = -WORLD_WIDTH * 0.5f;
+    m_wrapFirst = static_cast<int>(std::floor((left - worldMin) / WORLD_WIDTH));
+    int wrapLast = static_cast<int>(std::ceil((right - worldMin) / WORLD_WIDTH)) - 1;
+    m_wrapCount = std::max(1, wrapLast - m_wrapFirst + 1);
+    
+    setCullRects(m_cull, left, right, bottom, top);
+    updateCullScale();
+    
+    setProjection(ortho);
+}
+
+void Renderer::setViewTile(const ViewTile& tile) {
+    m_tile = tile;
+    setView(m_view);
+}
+
+void Renderer::setCullRects(ViewCull& cull, float left, float right, float bottom, float top) {
+    // The window expressed in principal-copy longitudes, one rect per copy it overlaps
+    const float worldMin = -WORLD_WIDTH * 0.5f;
+    const int first = static_cast<int>(std::floor((left - worldMin) / WORLD_WIDTH));
+    const int last = static_cast<int>(std::ceil((right - worldMin) / WORLD_WIDTH)) - 1;
+    
+    cull.rectCount = 0;
+    for (int copy = first; copy <= last && cull.rectCount < MAX_VISIBLE_RECTS; copy++) {
+        const float offset = copy * WORLD_WIDTH;
+        Bounds rect{std::max(left - offset, worldMin), bottom,
+                    std::min(right - offset, -worldMin), top};
+        if (rect.minX <= rect.maxX) {
+            cull.rects[cull.rectCount++] = rect;
+        }
+    }
+}
+
+void Renderer::setProjection(const float* matrix) {
+    const std::pair<const ShaderProgram*, const ProgramUniforms*> programs[] = {
+        {&m_basicShader, &m_basicUniforms},
+        {&m_glowShader, &m_glowUniforms},
+        {&m_instanceShader, &m_instanceUniforms},
+        {&m_instanceGlowShader, &m_instanceGlowUniforms},
+        {&m_trailShader, &m_trailUniforms},
+        {&m_trailGlowShader, &m_trailGlowUniforms}
+    };
+    for (const auto& entry : programs) {
+        if (!entry.first->isValid()) continue;
+        entry.first->use();
+        glUniformMatrix4fv(entry.second->projection, 1, GL_FALSE, matrix);
+    }
+}
+
+void Renderer::beginOverlay() {
+    drawBatch();
+    
+    // Reference-pixel space, y down, a single copy at offset zero
+    const float width = m_viewportWidth / m_pixelScale;
+    const float height = m_viewportHeight / m_pixelScale;
+    const float ortho[16] = {
+        2.0f / width, 0.0f, 0.0f, 0.0f,
+        0.0f, -2.0f / height, 0.0f, 0.0f,
+        0.0f, 0.0f, -1.0f, 0.0f,
+        -1.0f, 1.0f, 0.0f, 1.0f
+    };
+    m_wrapFirst = 0;
+    m_wrapCount = 1;
+    setProjection(ortho);
+}
+
+void Renderer::endOverlay() {
+    // Restores the world projection and wrap range
+    setView(m_view);
+}
+
+int Renderer::getVisibleRects(const Bounds*& rects) const {
+    rects = m_cull.rects;
+    return m_cull.rectCount;
+}
+
+void Renderer::updateCullScale() {
+    // Reference pixels -> target pixels -> degrees of the tile at the current zoom
+    const float zoom = std::max(m_view.zoom, 1.0f);
+    m_cull.degreesPerPixelX = m_pixelScale * WORLD_WIDTH * m_tile.width / (zoom * std::max(m_viewportWidth, 1));
+    m_cull.degreesPerPixelY = m_pixelScale * WORLD_HEIGHT * m_tile.height / (zoom * std::max(m_viewportHeight, 1));
+    
+    // Tiles of a wall share a pixel size, so the view's margins match the tile's
+    m_viewCull.degreesPerPixelX = m_cull.degreesPerPixelX;
+    m_viewCull.degreesPerPixelY = m_cull.degreesPerPixelY;
+}
+
+template <typename DrawFn>
+void Renderer::drawWrapped(const ProgramUniforms& uniforms, DrawFn draw) {
+    for (int copy = m_wrapFirst; copy < m_wrapFirst + m_wrapCount; copy++) {
+        glUniform1f(uniforms.wrapOffset, copy * WORLD_WIDTH);
+        draw();
+        m_stats.drawCalls++;
+    }
+}
+
+void Renderer::resize(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    
+    m_width = width;
+    m_height = height;
+    setViewport(width, height);
+}
+
+void Renderer::setViewport(int width, int height) {
+    // Queued geometry belongs to the previous target
+    drawBatch();
+    glViewport(0, 0, width, height);
+    
+    if (width == m_viewportWidth && height == m_viewportHeight) return;
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+    m_pixelScale = static_cast<float>(height) / SCREEN_HEIGHT;
+    updateCullScale();
+    
+    const float w = static_cast<float>(width);
+    const float h = static_cast<float>(height);
+    
+    const std::pair<const ShaderProgram*, const ProgramUniforms*> programs[] = {
+        {&m_glowShader, &m_glowUniforms},
+        {&m_instanceShader, &m_instanceUniforms},
+        {&m_instanceGlowShader, &m_instanceGlowUniforms},
+        {&m_trailGlowShader, &m_trailGlowUniforms}
+    };
+    for (const auto& entry : programs) {
+        if (!entry.first->isValid()) continue;
+        entry.first->use();
+        glUniform2f(entry.second->viewport, w, h);
+        glUniform1f(entry.second->pixelScale, m_pixelScale);
+        // Reference pixels to clip units; icon meshes are authored y-down
+        glUniform2f(entry.second->pixelToClip, 2.0f * m_pixelScale / w, -2.0f * m_pixelScale / h);
+    }
+}
+
+void Renderer::setupMeshes() {
+    // Every mesh is stored as independent GL_LINES segments so the glow
+    // geometry shader can expand them like any batched line
+    std::vector<Point> vertices;
+    auto addSegment = [&vertices](float x1, float y1, float x2, float y2) {
+        vertices.push_back(Point(x1, y1));
+        vertices.push_back(Point(x2, y2));
+    };
+    auto beginMesh = [&](Mesh mesh) {
+        m_meshes[static_cast<size_t>(mesh)].first = static_cast<GLint>(vertices.size());
+    };
+    auto endMesh = [&](Mesh mesh) {
+        MeshRange& range = m_meshes[static_cast<size_t>(mesh)];
+        range.count = static_cast<GLsizei>(vertices.size()) - range.first;
+    };
+    
+    beginMesh(Mesh::Circle);
+    Point circle[CIRCLE_SEGMENTS + 1];
+    buildCircle(0.0f, 0.0f, 1.0f, circle);
+    for (int i = 1; i <= CIRCLE_SEGMENTS; i++) {
+        addSegment(circle[i - 1].x, circle[i - 1].y, circle[i].x, circle[i].y);
+    }
+    endMesh(Mesh::Circle);
+    
+    // Triangle pointing upward
+    beginMesh(Mesh::SiloIcon);
+    {
+        const float size = 12.0f;
+        const Point p1(0.0f, -size);
+        const Point p2(-size * 0.866f, size * 0.5f);
+        const Point p3(size * 0.866f, size * 0.5f);
+        addSegment(p1.x, p1.y, p2.x, p2.y);
+        addSegment(p2.x, p2.y, p3.x, p3.y);
+        addSegment(p3.x, p3.y, p1.x, p1.y);
+    }
+    endMesh(Mesh::SiloIcon);
+    
+    // Hull outline, conning tower and periscope
+    beginMesh(Mesh::SubmarineIcon);
+    {
+        const float size = 8.0f;
+        const Point hull[] = {
+            Point(-12.0f, 0.0f), Point(-10.0f, -3.0f), Point(-6.0f, -4.0f), Point(6.0f, -4.0f),
+            Point(10.0f, -3.0f), Point(12.0f, 0.0f), Point(10.0f, 2.0f), Point(-10.0f, 2.0f)
+        };
+        const int hullCount = static_cast<int>(sizeof(hull) / sizeof(hull[0]));
+        for (int i = 0; i < hullCount; i++) {
+            const Point& a = hull[i];
+            const Point& b = hull[(i + 1) % hullCount];
+            addSegment(a.x, a.y, b.x, b.y);
+        }
+        
+        const float towerX = size * 0.25f;
+        addSegment(-towerX, -size * 0.5f, -towerX, -size * 1.1f);
+        addSegment(-towerX, -size * 1.1f, towerX, -size * 1.1f);
+        addSegment(towerX, -size * 1.1f, towerX, -size * 0.5f);
+        addSegment(towerX, -size * 0.5f, -towerX, -size * 0.5f);
+        
+        addSegment(0.0f, -size * 1.1f, 0.0f, -size * 1.4f);
+    }
+    endMesh(Mesh::SubmarineIcon);
+    
+    // Short leader line and a small box, drawn beside the aircraft
+    beginMesh(Mesh::AircraftTag);
+    {
+        const float tagX = 10.0f;
+        const float tagY = -8.0f;
+        const float tagW = 10.0f;
+        const float tagH = 6.0f;
+        addSegment(0.0f, 0.0f, tagX, tagY);
+        addSegment(tagX, tagY, tagX + tagW, tagY);
+        addSegment(tagX + tagW, tagY, tagX + tagW, tagY + tagH);
+        addSegment(tagX + tagW, tagY + tagH, tagX, tagY + tagH);
+        addSegment(tagX, tagY + tagH, tagX, tagY);
+    }
+    endMesh(Mesh::AircraftTag);
+    
+    glGenVertexArrays(1, &m_meshVao);
+    glGenBuffers(1, &m_meshVbo);
+    glGenBuffers(1, &m_instanceVbo);
+    
+    glBindVertexArray(m_meshVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_meshVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Point), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Point), (void*)0);
+    glEnableVertexAttribArray(0);
+    
+    // Instance attributes are pointed at each bucket's range when drawn
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    m_instanceCapacity = INITIAL_INSTANCE_BYTES;
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity, nullptr, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    
+    glBindVertexArray(0);
+}
+
+void Renderer::setupTrails() {
+    glGenVertexArrays(1, &m_trailVao);
+    glGenBuffers(1, &m_trailInstanceVbo);
+    glGenBuffers(1, &m_trailPointBuffer);
+    glGenTextures(1, &m_trailPointTexture);
+    
+    // Path offset and point count, then color, once per trail; the points
+    // themselves come from the trajectory buffer
+    glBindVertexArray(m_trailVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_trailInstanceVbo);
+    m_trailInstanceCapacity = INITIAL_TRAIL_INSTANCE_BYTES;
+    glBufferData(GL_ARRAY_BUFFER, m_trailInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(0, 1);
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+    
+    GLint limit = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &limit);
+    m_trailPointLimit = static_cast<size_t>(std::max(limit, 0));
+    reserveTrailPoints(std::min(INITIAL_TRAIL_POINTS, m_trailPointLimit));
+}
+
+void Renderer::reserveTrailPoints(size_t points) {
+    if (points <= m_trailPointCapacity) return;
+    
+    const size_t capacity = std::min(std::max(points, m_trailPointCapacity * 2), m_trailPointLimit);
+    if (capacity <= m_trailPointCapacity) return;
+    
+    // A larger buffer starts as a copy of the old one, so paths uploaded
+    // earlier stay valid
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity * sizeof(Point), nullptr, GL_DYNAMIC_DRAW);
+    if (m_trailPointCapacity > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_trailPointBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_trailPointCapacity * sizeof(Point));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    
+    glDeleteBuffers(1, &m_trailPointBuffer);
+    m_trailPointBuffer = buffer;
+    m_trailPointCapacity = capacity;
+    
+    glBindTexture(GL_TEXTURE_BUFFER, m_trailPointTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, m_trailPointBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
 }
 
 void Renderer::shutdown() {
-    if (m_basicShader) {
-        glDeleteProgram(m_basicShader);
+    m_basicShader.destroy();
+    m_glowShader.destroy();
+    m_instanceShader.destroy();
+    m_instanceGlowShader.destroy();
+    m_trailShader.destroy();
+    m_trailGlowShader.destroy();
+    if (m_trailPointTexture) {
+        glDeleteTextures(1, &m_trailPointTexture);
+    }
+    if (m_trailPointBuffer) {
+        glDeleteBuffers(1, &m_trailPointBuffer);
+    }
+    if (m_trailInstanceVbo) {
+        glDeleteBuffers(1, &m_trailInstanceVbo);
+    }
+    if (m_trailVao) {
+        glDeleteVertexArrays(1, &m_trailVao);
+    }
+    if (m_instanceVbo) {
+        glDeleteBuffers(1, &m_instanceVbo);
+    }
+    if (m_meshVbo) {
+        glDeleteBuffers(1, &m_meshVbo);
+    }
+    if (m_meshVao) {
+        glDeleteVertexArrays(1, &m_meshVao);
     }
     if (m_vbo) {
         glDeleteBuffers(1, &m_vbo);
@@ -203,15 +807,83 @@ void Renderer::shutdown() {
 }
 
 void Renderer::clear(const Color& color) {
+    drawBatch();
     glClearColor(color.r, color.g, color.b, color.a);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void Renderer::present() {
-    SDL_GL_SwapWindow(m_window);
+    drawBatch();
+    
+    // Only the primary window waits for vsync. Drivers that keep the swap
+    // interval per context would otherwise make every window of a wall
+    // wait, so it is switched before each swap that needs the other value.
+    const int interval = (m_currentWindow == m_window && m_vsyncActive) ? 1 : 0;
+    if (interval != m_swapInterval) {
+        SDL_GL_SetSwapInterval(interval);
+        m_swapInterval = interval;
+    }
+    SDL_GL_SwapWindow(m_currentWindow);
+}
+
+SDL_Window* Renderer::createWindow(const char* title, const SDL_Rect& bounds, bool fullscreen, bool hidden) {
+    SDL_Window* window = SDL_CreateWindow(
+        title, bounds.x, bounds.y, bounds.w, bounds.h,
+        SDL_WINDOW_OPENGL | SDL_WINDOW_ALLOW_HIGHDPI |
+        (fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP | SDL_WINDOW_BORDERLESS : SDL_WINDOW_RESIZABLE) |
+        (hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
+    );
+    if (!window) {
+        std::cerr << "Failed to create window: " << SDL_GetError() << "\n";
+        return nullptr;
+    }
+    
+    // The context is made current on the new window once to give it an
+    // immediate swap interval: the primary window paces the frame, and a
+    // vsync wait per window would divide the frame rate. Drivers that keep
+    // the interval per context rather than per drawable are handled by
+    // present(), which switches it around every swap.
+    if (SDL_GL_MakeCurrent(window, m_glContext) != 0) {
+        std::cerr << "Failed to share the GL context with a new window: " << SDL_GetError() << "\n";
+        SDL_GL_MakeCurrent(m_currentWindow, m_glContext);
+        SDL_DestroyWindow(window);
+        return nullptr;
+    }
+    SDL_GL_SetSwapInterval(0);
+    SDL_GL_MakeCurrent(m_window, m_glContext);
+    SDL_GL_SetSwapInterval(m_vsyncActive ? 1 : 0);
+    m_swapInterval = m_vsyncActive ? 1 : 0;
+    if (m_currentWindow != m_window) SDL_GL_MakeCurrent(m_currentWindow, m_glContext);
+    return window;
+}
+
+void Renderer::destroyWindow(SDL_Window* window) {
+    if (!window || window == m_window) return;
+    if (window == m_currentWindow) {
+        // Sizes are refreshed by the next selectWindow()
+        drawBatch();
+        SDL_GL_MakeCurrent(m_window, m_glContext);
+        m_currentWindow = m_window;
+    }
+    SDL_DestroyWindow(window);
+}
+
+void Renderer::selectWindow(SDL_Window* window, int width, int height) {
+    // Queued geometry belongs to the previous window
+    drawBatch();
+    if (window != m_currentWindow) {
+        SDL_GL_MakeCurrent(window, m_glContext);
+        m_currentWindow = window;
+    }
+    if (width > 0 && height > 0) {
+        m_width = width;
+        m_height = height;
+    }
 }
 
 void Renderer::setAdditiveBlending(bool enabled) {
+    // Blend state applies to the whole batch, so draw what was queued first
+    drawBatch();
     if (enabled) {
         glBlendFunc(GL_ONE, GL_ONE);
     } else {
@@ -219,99 +891,447 @@ void Renderer::setAdditiveBlending(bool enabled) {
     }
 }
 
-void Renderer::drawLine(float x1, float y1, float x2, float y2, const Color& color, float width) {
-    glUseProgram(m_basicShader);
-    glLineWidth(width);
+void Renderer::setGlowMode(GlowMode mode) {
+    if (mode == GlowMode::Shader && !m_glowShader.isValid()) {
+        std::cerr << "Shader glow unavailable, keeping layered glow\n";
+        return;
+    }
+    drawBatch();
+    m_glowMode = mode;
+    m_batch.setGlowMode(mode);
+}
+
+void Renderer::beginBatch() {
+    m_batching = true;
+}
+
+void Renderer::flushBatch() {
+    drawBatch();
+    m_batching = false;
+}
+
+void Renderer::submitLine(float x1, float y1, float x2, float y2, const Color& color, float width, int glowLayers) {
+    m_batch.submitLine(x1, y1, x2, y2, color, width, glowLayers);
+    
+    if (!m_batching) drawBatch();
+}
+
+void Renderer::submitPath(const Point* points, size_t count, const Color& color, float width, int glowLayers) {
+    m_batch.submitPath(points, count, color, width, glowLayers);
+    
+    if (!m_batching) drawBatch();
+}
+
+void Renderer::submitInstance(Mesh mesh, const ShapeInstance& instance, int glowLayers, MeshAnimation animation) {
+    m_batch.submitInstance(mesh, instance, glowLayers, animation);
+    
+    if (!m_batching) drawBatch();
+}
+
+void Renderer::setupDrawList(DrawList& list) const {
+    list.clear();
+    list.setGlowMode(m_glowMode);
+    list.setCull(m_viewCull);
+}
+
+void Renderer::draw(DrawList& list) {
+    drawRetained(list);
+    list.clear();
+}
+
+void Renderer::drawRetained(DrawList& list) {
+    drawLines(list);
+    drawTrails(list);
+    drawInstances(list);
+    list.clearTrailUploads();
+}
+
+void Renderer::drawBatch() {
+    draw(m_batch);
+}
+
+void Renderer::drawLines(const DrawList& list) {
+    const size_t totalVertices = list.lineVertexCount();
+    if (totalVertices == 0) return;
     
-    float vertices[] = { x1, y1, x2, y2 };
+    const auto& buckets = list.lineBuckets();
+    const auto& glowVertices = list.glowVertices();
+    
+    const size_t bytes = totalVertices * sizeof(LineVertex);
     
     glBindVertexArray(m_vao);
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
     
-    GLint colorLoc = glGetUniformLocation(m_basicShader, "color");
-    glUniform4f(colorLoc, color.r, color.g, color.b, color.a);
+    // Ring allocation: append after the previous upload and orphan the
+    // storage when full so the driver never waits on in-flight draws
+    if (m_vboOffset + bytes > m_vboCapacity) {
+        while (bytes > m_vboCapacity) {
+            m_vboCapacity *= 2;
+        }
+        glBufferData(GL_ARRAY_BUFFER, m_vboCapacity, nullptr, GL_STREAM_DRAW);
+        m_vboOffset = 0;
+    }
+    
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, m_vboOffset, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!mapped) {
+        std::cerr << "Failed to map line batch buffer\n";
+        return;
+    }
+    
+    auto* dst = static_cast<unsigned char*>(mapped);
+    for (const auto& bucket : buckets) {
+        const size_t bucketBytes = bucket.vertices.size() * sizeof(LineVertex);
+        std::memcpy(dst, bucket.vertices.data(), bucketBytes);
+        dst += bucketBytes;
+    }
+    std::memcpy(dst, glowVertices.data(), glowVertices.size() * sizeof(LineVertex));
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    m_stats.uploadBytes += bytes;
+    
+    GLint first = static_cast<GLint>(m_vboOffset / sizeof(LineVertex));
+    
+    m_basicShader.use();
+    for (const auto& bucket : buckets) {
+        if (bucket.vertices.empty()) continue;
+        
+        GLsizei count = static_cast<GLsizei>(bucket.vertices.size());
+        glLineWidth(bucket.width * m_pixelScale);
+        drawWrapped(m_basicUniforms, [&]() { glDrawArrays(GL_LINES, first, count); });
+        first += count;
+    }
     
-    glDrawArrays(GL_LINES, 0, 2);
+    if (!glowVertices.empty()) {
+        const GLsizei count = static_cast<GLsizei>(glowVertices.size());
+        m_glowShader.use();
+        drawWrapped(m_glowUniforms, [&]() { glDrawArrays(GL_LINES, first, count); });
+    }
+    
+    m_vboOffset += bytes;
 }
 
-void Renderer::drawLineWithGlow(float x1, float y1, float x2, float y2, const Color& color, int layers) {
-    // Draw multiple layers with decreasing alpha and increasing width
+void Renderer::drawInstances(const DrawList& list) {
+    const size_t totalInstances = list.instanceCount();
+    if (totalInstances == 0) return;
+    
+    const auto& buckets = list.instanceBuckets();
+    
+    const size_t bytes = totalInstances * sizeof(ShapeInstance);
+    
+    glBindVertexArray(m_meshVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    
+    // Instance data is small, so it is simply orphaned and refilled per flush
+    while (bytes > m_instanceCapacity) {
+        m_instanceCapacity *= 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity, nullptr, GL_STREAM_DRAW);
+    
+    size_t offset = 0;
+    for (const auto& bucket : buckets) {
+        const size_t bucketBytes = bucket.instances.size() * sizeof(ShapeInstance);
+        if (bucketBytes == 0) continue;
+        glBufferSubData(GL_ARRAY_BUFFER, offset, bucketBytes, bucket.instances.data());
+        offset += bucketBytes;
+    }
+    m_stats.uploadBytes += bytes;
+    
+    offset = 0;
+    for (const auto& bucket : buckets) {
+        if (bucket.instances.empty()) continue;
+        drawInstanceBucket(bucket, offset);
+        offset += bucket.instances.size() * sizeof(ShapeInstance);
+    }
+    
+    glBindVertexArray(0);
+}
+
+void Renderer::drawInstanceBucket(const DrawList::InstanceBucket& bucket, size_t byteOffset) {
+    const MeshRange& range = m_meshes[static_cast<size_t>(bucket.mesh)];
+    
+    // Explosion instances are repeated once per ring; the shader picks the
+    // ring from gl_InstanceID
+    const GLuint divisor = (bucket.animation == MeshAnimation::ExplosionRings) ? EXPLOSION_RINGS : 1;
+    const GLsizei instanceCount = static_cast<GLsizei>(bucket.instances.size() * divisor);
+    
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(ShapeInstance),
+                          (void*)(byteOffset + offsetof(ShapeInstance, x)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ShapeInstance),
+                          (void*)(byteOffset + offsetof(ShapeInstance, r)));
+    glVertexAttribDivisor(1, divisor);
+    glVertexAttribDivisor(2, divisor);
+    
+    const GLint animation = static_cast<GLint>(bucket.animation);
+    
+    if (m_glowMode == GlowMode::Shader && m_instanceGlowShader.isValid()) {
+        m_instanceGlowShader.use();
+        glUniform1i(m_instanceGlowUniforms.animation, animation);
+        glUniform2f(m_instanceGlowUniforms.style, 1.0f,
+                    static_cast<float>(std::min(bucket.glowLayers, MAX_GLOW_LAYERS)));
+        glUniform1f(m_instanceGlowUniforms.alphaScale, 1.0f);
+        drawWrapped(m_instanceGlowUniforms, [&]() {
+            glDrawArraysInstanced(GL_LINES, range.first, range.count, instanceCount);
+        });
+        return;
+    }
+    
+    m_instanceShader.use();
+    glUniform1i(m_instanceUniforms.animation, animation);
+    
+    if (bucket.glowLayers <= 0) {
+        glUniform2f(m_instanceUniforms.style, 1.0f, 0.0f);
+        glUniform1f(m_instanceUniforms.alphaScale, 1.0f);
+        glLineWidth(m_pixelScale);
+        drawWrapped(m_instanceUniforms, [&]() {
+            glDrawArraysInstanced(GL_LINES, range.first, range.count, instanceCount);
+        });
+        return;
+    }
+    
+    // Same layer profile as submitPath, one instanced draw per layer
+    const int layers = bucket.glowLayers;
     for (int i = layers - 1; i >= 0; i--) {
         float layerAlpha = (i == 0) ? 1.0f : 0.3f / layers;
         float layerWidth = 1.0f + (layers - i) * 0.8f;
         
-        Color layerColor(color.r, color.g, color.b, color.a * layerAlpha);
-        drawLine(x1, y1, x2, y2, layerColor, layerWidth);
+        glUniform2f(m_instanceUniforms.style, layerWidth, 0.0f);
+        glUniform1f(m_instanceUniforms.alphaScale, layerAlpha);
+        glLineWidth(layerWidth * m_pixelScale);
+        drawWrapped(m_instanceUniforms, [&]() {
+            glDrawArraysInstanced(GL_LINES, range.first, range.count, instanceCount);
+        });
     }
 }
 
-void Renderer::drawCircle(float x, float y, float radius, const Color& color, float width) {
-    glUseProgram(m_basicShader);
-    glLineWidth(width);
+void Renderer::uploadTrailPoints(const DrawList& list) {
+    const auto& uploads = list.trailUploads();
+    if (uploads.empty()) return;
     
-    const int segments = 32;
-    std::vector<float> vertices;
-    vertices.reserve(segments * 2 + 2);
+    size_t needed = 0;
+    for (const auto& upload : uploads) {
+        needed = std::max(needed, static_cast<size_t>(upload.offset) + upload.count);
+    }
+    // Reported once; paths past the limit are clipped every frame after
+    if (needed > m_trailPointLimit && !m_warnedTrailLimit) {
+        std::cerr << "Trajectory buffer needs " << needed << " points, driver limit is "
+                  << m_trailPointLimit << "; trails past it are not drawn\n";
+        m_warnedTrailLimit = true;
+    }
+    reserveTrailPoints(needed);
     
-    for (int i = 0; i <= segments; i++) {
-        float angle = (i / static_cast<float>(segments)) * 2.0f * M_PI;
-        vertices.push_back(x + std::cos(angle) * radius);
-        vertices.push_back(y + std::sin(angle) * radius);
+    const Point* points = list.trailPoints().data();
+    glBindBuffer(GL_TEXTURE_BUFFER, m_trailPointBuffer);
+    for (const auto& upload : uploads) {
+        if (upload.offset >= m_trailPointCapacity) continue;
+        const size_t count = std::min<size_t>(upload.count, m_trailPointCapacity - upload.offset);
+        glBufferSubData(GL_TEXTURE_BUFFER, upload.offset * sizeof(Point), count * sizeof(Point),
+                        points + upload.start);
+        m_stats.uploadBytes += count * sizeof(Point);
     }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Renderer::drawTrails(const DrawList& list) {
+    // Points go up even when nothing is drawn, since later lists rely on them
+    uploadTrailPoints(list);
     
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+    const size_t totalTrails = list.trailCount();
+    if (totalTrails == 0 || !m_trailShader.isValid()) return;
     
-    GLint colorLoc = glGetUniformLocation(m_basicShader, "color");
-    glUniform4f(colorLoc, color.r, color.g, color.b, color.a);
+    const auto& buckets = list.trailBuckets();
+    const size_t bytes = totalTrails * sizeof(TrailInstance);
+    
+    glBindVertexArray(m_trailVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_trailInstanceVbo);
+    
+    // A few dozen bytes per missile, orphaned and refilled like instances
+    while (bytes > m_trailInstanceCapacity) {
+        m_trailInstanceCapacity *= 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, m_trailInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    
+    size_t offset = 0;
+    for (const auto& bucket : buckets) {
+        const size_t bucketBytes = bucket.trails.size() * sizeof(TrailInstance);
+        if (bucketBytes == 0) continue;
+        glBufferSubData(GL_ARRAY_BUFFER, offset, bucketBytes, bucket.trails.data());
+        offset += bucketBytes;
+    }
+    m_stats.uploadBytes += bytes;
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, m_trailPointTexture);
+    
+    offset = 0;
+    for (const auto& bucket : buckets) {
+        if (bucket.trails.empty()) continue;
+        drawTrailBucket(bucket, offset);
+        offset += bucket.trails.size() * sizeof(TrailInstance);
+    }
     
-    glDrawArrays(GL_LINE_STRIP, 0, segments + 1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindVertexArray(0);
 }
 
-void Renderer::drawCircleWithGlow(float x, float y, float radius, const Color& color, int layers) {
+void Renderer::drawTrailBucket(const DrawList::TrailBucket& bucket, size_t byteOffset) {
+    const GLsizei vertexCount = static_cast<GLsizei>(2 * (bucket.maxCount - 1));
+    const GLsizei trailCount = static_cast<GLsizei>(bucket.trails.size());
+    
+    glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(TrailInstance),
+                           (void*)(byteOffset + offsetof(TrailInstance, offset)));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TrailInstance),
+                          (void*)(byteOffset + offsetof(TrailInstance, r)));
+    
+    if (m_glowMode == GlowMode::Shader && m_trailGlowShader.isValid()) {
+        m_trailGlowShader.use();
+        glUniform2f(m_trailGlowUniforms.style, 1.0f, static_cast<float>(bucket.glowLayers));
+        glUniform1f(m_trailGlowUniforms.alphaScale, 1.0f);
+        drawWrapped(m_trailGlowUniforms, [&]() {
+            glDrawArraysInstanced(GL_LINES, 0, vertexCount, trailCount);
+        });
+        return;
+    }
+    
+    m_trailShader.use();
+    
+    if (bucket.glowLayers <= 0) {
+        glUniform2f(m_trailUniforms.style, 1.0f, 0.0f);
+        glUniform1f(m_trailUniforms.alphaScale, 1.0f);
+        glLineWidth(m_pixelScale);
+        drawWrapped(m_trailUniforms, [&]() {
+            glDrawArraysInstanced(GL_LINES, 0, vertexCount, trailCount);
+        });
+        return;
+    }
+    
+    // Same layer profile as submitPath, one instanced draw per layer
+    const int layers = bucket.glowLayers;
     for (int i = layers - 1; i >= 0; i--) {
         float layerAlpha = (i == 0) ? 1.0f : 0.3f / layers;
         float layerWidth = 1.0f + (layers - i) * 0.8f;
         
-        Color layerColor(color.r, color.g, color.b, color.a * layerAlpha);
-        drawCircle(x, y, radius, layerColor, layerWidth);
+        glUniform2f(m_trailUniforms.style, layerWidth, 0.0f);
+        glUniform1f(m_trailUniforms.alphaScale, layerAlpha);
+        glLineWidth(layerWidth * m_pixelScale);
+        drawWrapped(m_trailUniforms, [&]() {
+            glDrawArraysInstanced(GL_LINES, 0, vertexCount, trailCount);
+        });
     }
 }
 
+void Renderer::drawLine(float x1, float y1, float x2, float y2, const Color& color, float width) {
+    submitLine(x1, y1, x2, y2, color, width);
+}
+
+void Renderer::drawLineWithGlow(float x1, float y1, float x2, float y2, const Color& color, int layers) {
+    submitLine(x1, y1, x2, y2, color, 1.0f, layers);
+}
+
+void Renderer::buildCircle(float x, float y, float radius, Point* points) {
+    for (int i = 0; i <= CIRCLE_SEGMENTS; i++) {
+        float angle = (i / static_cast<float>(CIRCLE_SEGMENTS)) * 2.0f * M_PI;
+        points[i] = Point(x + std::cos(angle) * radius, y + std::sin(angle) * radius);
+    }
+}
+
+void Renderer::drawCircle(float x, float y, float radius, const Color& color, float width) {
+    Point points[CIRCLE_SEGMENTS + 1];
+    buildCircle(x, y, radius, points);
+    submitPath(points, CIRCLE_SEGMENTS + 1, color, width);
+}
+
+void Renderer::drawCircleWithGlow(float x, float y, float radius, const Color& color, int layers) {
+    Point points[CIRCLE_SEGMENTS + 1];
+    buildCircle(x, y, radius, points);
+    submitPath(points, CIRCLE_SEGMENTS + 1, color, 1.0f, layers);
+}
+
 void Renderer::drawPath(const std::vector<Point>& points, const Color& color, float width) {
-    if (points.size() < 2) return;
-    
-    glUseProgram(m_basicShader);
-    glLineWidth(width);
+    submitPath(points.data(), points.size(), color, width);
+}
+
+void Renderer::drawPathWithGlow(const std::vector<Point>& points, const Color& color, int layers) {
+    submitPath(points.data(), points.size(), color, 1.0f, layers);
+}
+
+bool Renderer::createStaticLines(StaticLineBuffer& out, const std::vector<Point>& points) {
+    return createStaticLines(out, points.data(), points.size());
+}
+
+bool Renderer::createStaticLines(StaticLineBuffer& out, const Point* points, size_t count) {
+    destroyStaticLines(out);
+    if (count == 0) return false;
     
-    std::vector<float> vertices;
-    vertices.reserve(points.size() * 2);
+    glGenVertexArrays(1, &out.vao);
+    glGenBuffers(1, &out.vbo);
     
-    for (const auto& p : points) {
-        vertices.push_back(p.x);
-        vertices.push_back(p.y);
-    }
+    glBindVertexArray(out.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, out.vbo);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(Point), points, GL_STATIC_DRAW);
+    m_stats.uploadBytes += count * sizeof(Point);
     
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+    // Only positions are stored; color and width come from the constant
+    // attribute values set in drawStaticLines
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Point), (void*)0);
+    glEnableVertexAttribArray(0);
     
-    GLint colorLoc = glGetUniformLocation(m_basicShader, "color");
-    glUniform4f(colorLoc, color.r, color.g, color.b, color.a);
+    glBindVertexArray(0);
     
-    glDrawArrays(GL_LINE_STRIP, 0, points.size());
+    out.vertexCount = static_cast<GLsizei>(count);
+    return true;
 }
 
-void Renderer::drawPathWithGlow(const std::vector<Point>& points, const Color& color, int layers) {
+void Renderer::drawStaticLines(const StaticLineBuffer& buffer, const GLint* firsts, const GLsizei* counts,
+                               GLsizei drawCount, const Color& color, float width) {
+    drawStaticLinesStyled(buffer, firsts, counts, drawCount, color, width, 0);
+}
+
+void Renderer::drawStaticLinesWithGlow(const StaticLineBuffer& buffer, const GLint* firsts, const GLsizei* counts,
+                                       GLsizei drawCount, const Color& color, int layers) {
+    if (m_glowMode == GlowMode::Shader) {
+        drawStaticLinesStyled(buffer, firsts, counts, drawCount, color, 1.0f, std::min(layers, MAX_GLOW_LAYERS));
+        return;
+    }
+    
     for (int i = layers - 1; i >= 0; i--) {
         float layerAlpha = (i == 0) ? 1.0f : 0.3f / layers;
         float layerWidth = 1.0f + (layers - i) * 0.8f;
         
         Color layerColor(color.r, color.g, color.b, color.a * layerAlpha);
-        drawPath(points, layerColor, layerWidth);
+        drawStaticLinesStyled(buffer, firsts, counts, drawCount, layerColor, layerWidth, 0);
+    }
+}
+
+void Renderer::drawStaticLinesStyled(const StaticLineBuffer& buffer, const GLint* firsts, const GLsizei* counts,
+                                     GLsizei drawCount, const Color& color, float width, int glowLayers) {
+    if (!buffer.vao || drawCount <= 0) return;
+    
+    drawBatch();
+    
+    const bool shaderGlow = (m_glowMode == GlowMode::Shader);
+    if (shaderGlow) {
+        m_glowShader.use();
+    } else {
+        m_basicShader.use();
+        glLineWidth(width * m_pixelScale);
     }
+    glVertexAttrib4f(1, color.r, color.g, color.b, color.a);
+    glVertexAttrib2f(2, width, static_cast<float>(glowLayers));
+    
+    glBindVertexArray(buffer.vao);
+    drawWrapped(shaderGlow ? m_glowUniforms : m_basicUniforms, [&]() {
+        glMultiDrawArrays(GL_LINE_STRIP, firsts, counts, drawCount);
+    });
+    glBindVertexArray(0);
+}
+
+void Renderer::destroyStaticLines(StaticLineBuffer& buffer) {
+    // The context may already be gone when owners are torn down after shutdown()
+    if (m_initialized) {
+        if (buffer.vbo) glDeleteBuffers(1, &buffer.vbo);
+        if (buffer.vao) glDeleteVertexArrays(1, &buffer.vao);
+    }
+    buffer = StaticLineBuffer{};
 }
 
 GLuint Renderer::loadShader(const std::string& vertexPath, const std::string& fragmentPath) {
@@ -322,54 +1342,75 @@ GLuint Renderer::loadShader(const std::string& vertexPath, const std::string& fr
         return 0;
     }
 
-    const char* vertCode = vertSource.c_str();
-    const char* fragCode = fragSource.c_str();
+    return buildProgram(vertSource.c_str(), nullptr, fragSource.c_str());
+}
 
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertCode, NULL);
-    glCompileShader(vertexShader);
+GLuint Renderer::compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
 
     int success;
     char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "Vertex shader compilation failed:\n" << infoLog << "\n";
-        glDeleteShader(vertexShader);
+        const char* stage = (type == GL_VERTEX_SHADER) ? "Vertex"
+                          : (type == GL_GEOMETRY_SHADER) ? "Geometry" : "Fragment";
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cerr << stage << " shader compilation failed:\n" << infoLog << "\n";
+        glDeleteShader(shader);
         return 0;
     }
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragCode, NULL);
-    glCompileShader(fragmentShader);
+    return shader;
+}
 
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "Fragment shader compilation failed:\n" << infoLog << "\n";
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+GLuint Renderer::buildProgram(const char* vertexSource, const char* geometrySource, const char* fragmentSource) {
+    // A cached binary skips compiling and linking altogether
+    uint64_t cacheKey = 0;
+    if (m_shaderCache.isEnabled()) {
+        cacheKey = m_shaderCache.key(vertexSource, geometrySource, fragmentSource);
+        if (GLuint cached = m_shaderCache.load(cacheKey)) {
+            return cached;
+        }
+    }
+
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint geometryShader = geometrySource ? compileShader(GL_GEOMETRY_SHADER, geometrySource) : 0;
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    auto deleteStages = [&]() {
+        if (vertexShader) glDeleteShader(vertexShader);
+        if (geometryShader) glDeleteShader(geometryShader);
+        if (fragmentShader) glDeleteShader(fragmentShader);
+    };
+
+    if (!vertexShader || !fragmentShader || (geometrySource && !geometryShader)) {
+        deleteStages();
         return 0;
     }
 
     GLuint program = glCreateProgram();
     glAttachShader(program, vertexShader);
+    if (geometryShader) glAttachShader(program, geometryShader);
     glAttachShader(program, fragmentShader);
+    if (m_shaderCache.isEnabled()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(program);
 
+    int success;
+    char infoLog[512];
     glGetProgramiv(program, GL_LINK_STATUS, &success);
+    deleteStages();
     if (!success) {
         glGetProgramInfoLog(program, 512, NULL, infoLog);
         std::cerr << "Shader linking failed:\n" << infoLog << "\n";
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
         glDeleteProgram(program);
         return 0;
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
+    m_shaderCache.store(cacheKey, program);
     return program;
 }
 
@@ -381,17 +1422,19 @@ void Renderer::renderFullscreenQuad() {
     glBindVertexArray(m_quadVao);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
+    m_stats.drawCalls++;
 }
 
-GLuint Renderer::createFramebuffer(int width, int height, GLuint& textureOut) {
+GLuint Renderer::createFramebuffer(int width, int height, GLuint& textureOut, GLenum internalFormat) {
     GLuint fbo, texture;
+    const GLenum type = (internalFormat == GL_RGBA) ? GL_UNSIGNED_BYTE : GL_FLOAT;
     
     glGenFramebuffers(1, &fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
     
     glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, type, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
@@ -408,11 +1451,19 @@ GLuint Renderer::createFramebuffer(int width, int height, GLuint& textureOut) {
 }
 
 void Renderer::bindFramebuffer(GLuint fbo) {
+    drawBatch();
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 }
 
+void Renderer::bindFramebuffer(GLuint fbo, int width, int height) {
+    bindFramebuffer(fbo);
+    setViewport(width, height);
+}
+
 void Renderer::unbindFramebuffer() {
+    drawBatch();
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    setViewport(m_width, m_height);
 }
 
 void Renderer::setupScreenQuad() {
@@ -0,0 +1,311 @@
+#include "ScenarioFeed.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // Longest record accepted; anything longer is rejected unparsed
+    constexpr size_t MAX_RECORD_LENGTH = 255;
+
+    // Read buffer of the reader thread; also the largest UDP datagram read
+    constexpr size_t READ_BUFFER_BYTES = 64 * 1024;
+
+    // How often a blocked reader checks for close()
+    constexpr int POLL_TIMEOUT_MS = 100;
+
+    const char* skipSpaces(const char* p) {
+        while (*p == ' ' || *p == '\t') p++;
+        return p;
+    }
+
+    bool parseNumber(const char*& p, double& out) {
+        char* end = nullptr;
+        out = std::strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+        return true;
+    }
+
+    bool validLatLon(const LatLon& position) {
+        return position.lat >= -90.0 && position.lat <= 90.0 &&
+               position.lon >= -180.0 && position.lon <= 180.0;
+    }
+}
+
+ScenarioFeed::ScenarioFeed()
+    : m_queue(QUEUE_CAPACITY)
+    , m_fd(-1)
+    , m_live(false)
+    , m_datagram(false)
+    , m_replaySpeed(1.0)
+    , m_stopping(false)
+    , m_sourceDone(false)
+    , m_parsed(0)
+    , m_rejected(0)
+    , m_dropped(0)
+    , m_hasHeld(false)
+    , m_haveOrigin(false)
+    , m_timeOrigin(0.0)
+{
+}
+
+ScenarioFeed::~ScenarioFeed() {
+    close();
+}
+
+bool ScenarioFeed::open(const std::string& source, double replaySpeed) {
+    close();
+
+    m_replaySpeed = std::max(replaySpeed, 1e-3);
+    m_haveOrigin = false;
+    m_hasHeld = false;
+    m_stopping = false;
+    m_sourceDone = false;
+
+    if (source.compare(0, 4, "udp:") == 0) {
+        const int port = std::atoi(source.c_str() + 4);
+        if (port <= 0 || port > 65535) {
+            std::cerr << "Invalid feed port: " << source << "\n";
+            return false;
+        }
+
+        m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_fd < 0) {
+            std::cerr << "Failed to create feed socket: " << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        // Bursts of datagrams queue in the kernel while the reader parses
+        int receiveBuffer = 4 * 1024 * 1024;
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        if (::bind(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::cerr << "Failed to bind feed port " << port << ": " << std::strerror(errno) << "\n";
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+        m_live = true;
+        m_datagram = true;
+    } else {
+        // Non-blocking so opening a pipe does not wait for its writer
+        m_fd = ::open(source.c_str(), O_RDONLY | O_NONBLOCK);
+        if (m_fd < 0) {
+            std::cerr << "Failed to open feed " << source << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        struct stat info = {};
+        m_live = ::fstat(m_fd, &info) == 0 && S_ISFIFO(info.st_mode);
+        m_datagram = false;
+
+        if (m_live) {
+            // Holding the write end too keeps the pipe open between writers,
+            // so reads wait for data instead of seeing end-of-file
+            ::close(m_fd);
+            m_fd = ::open(source.c_str(), O_RDWR | O_NONBLOCK);
+            if (m_fd < 0) {
+                std::cerr << "Failed to open feed " << source << ": " << std::strerror(errno) << "\n";
+                return false;
+            }
+        }
+    }
+
+    m_thread = std::thread(&ScenarioFeed::readerLoop, this);
+    return true;
+}
+
+void ScenarioFeed::close() {
+    if (m_thread.joinable()) {
+        m_stopping = true;
+        m_thread.join();
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    // Nothing queued survives into the next source
+    LaunchEvent discard;
+    while (m_queue.tryPop(discard)) {}
+    m_hasHeld = false;
+}
+
+bool ScenarioFeed::finished() const {
+    return m_sourceDone.load(std::memory_order_acquire) && !m_hasHeld;
+}
+
+ScenarioFeed::Stats ScenarioFeed::stats() const {
+    Stats stats;
+    stats.parsed = m_parsed.load(std::memory_order_relaxed);
+    stats.rejected = m_rejected.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t ScenarioFeed::poll(double time, std::vector<LaunchEvent>& out, size_t maxEvents) {
+    // Replayed records are queued in timestamp order, so the first one not
+    // yet due ends the poll; it is held until a later call
+    const double replayTime = time * m_replaySpeed;
+    size_t taken = 0;
+    while (taken < maxEvents) {
+        if (!m_hasHeld) {
+            if (!m_queue.tryPop(m_held)) break;
+            m_hasHeld = true;
+        }
+        if (!m_live && m_held.time > replayTime) break;
+
+        out.push_back(m_held);
+        m_hasHeld = false;
+        taken++;
+    }
+    return taken;
+}
+
+bool ScenarioFeed::parseRecord(const char* line, size_t length, LaunchEvent& out) {
+    if (length > MAX_RECORD_LENGTH) return false;
+
+    char text[MAX_RECORD_LENGTH + 1];
+    std::memcpy(text, line, length);
+    text[length] = '\0';
+
+    const char* p = skipSpaces(text);
+    double time = 0.0;
+    if (!parseNumber(p, time) || !std::isfinite(time) || time < 0.0) return false;
+
+    p = skipSpaces(p);
+    if (*p == 'S' || *p == 's') {
+        out.type = MissileType::Silo;
+    } else if (*p == 'U' || *p == 'u') {
+        out.type = MissileType::Submarine;
+    } else {
+        return false;
+    }
+    p++;
+    if (*p != ' ' && *p != '\t') return false;
+
+    double values[4];
+    for (double& value : values) {
+        if (!parseNumber(p, value)) return false;
+    }
+    p = skipSpaces(p);
+    if (*p != '\0' && *p != '\r') return false;
+
+    out.time = time;
+    out.start = LatLon{values[0], values[1]};
+    out.end = LatLon{values[2], values[3]};
+    return validLatLon(out.start) && validLatLon(out.end);
+}
+
+size_t ScenarioFeed::parseLines(const char* data, size_t length, bool final) {
+    size_t lineStart = 0;
+    for (size_t i = 0; i <= length; i++) {
+        const bool lineEnd = (i < length) ? data[i] == '\n' : final;
+        if (!lineEnd) continue;
+
+        const char* line = data + lineStart;
+        const size_t lineLength = i - lineStart;
+        lineStart = i + 1;
+
+        size_t first = 0;
+        while (first < lineLength && (line[first] == ' ' || line[first] == '\t')) first++;
+        if (first == lineLength || line[first] == '#' || line[first] == '\r') continue;
+
+        LaunchEvent event;
+        if (parseRecord(line, lineLength, event)) {
+            m_parsed.fetch_add(1, std::memory_order_relaxed);
+            publish(event);
+        } else {
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (m_stopping.load(std::memory_order_relaxed)) break;
+    }
+    return std::min(lineStart, length);
+}
+
+void ScenarioFeed::publish(LaunchEvent& event) {
+    if (m_live) {
+        // Live records launch on arrival; with the queue full they are lost
+        // rather than stalling the socket
+        event.time = 0.0;
+        if (!m_queue.tryPush(std::move(event))) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    // Replay times count from the first record
+    if (!m_haveOrigin) {
+        m_timeOrigin = event.time;
+        m_haveOrigin = true;
+    }
+    event.time = std::max(0.0, event.time - m_timeOrigin);
+
+    // A file is read ahead only as far as the queue holds, so a long
+    // replay never buffers more than QUEUE_CAPACITY records
+    while (!m_queue.tryPush(std::move(event))) {
+        if (m_stopping.load(std::memory_order_relaxed)) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void ScenarioFeed::readerLoop() {
+    std::vector<char> buffer(READ_BUFFER_BYTES);
+    size_t buffered = 0;
+
+    while (!m_stopping.load(std::memory_order_relaxed)) {
+        pollfd descriptor = {};
+        descriptor.fd = m_fd;
+        descriptor.events = POLLIN;
+        const int ready = ::poll(&descriptor, 1, POLL_TIMEOUT_MS);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+
+        if (m_datagram) {
+            const ssize_t received = ::recv(m_fd, buffer.data(), buffer.size(), 0);
+            if (received > 0) parseLines(buffer.data(), static_cast<size_t>(received), true);
+            continue;
+        }
+
+        const ssize_t bytes = ::read(m_fd, buffer.data() + buffered, buffer.size() - buffered);
+        if (bytes < 0) {
+            if (errno == EAGAIN || errno == EINTR) continue;
+            break;
+        }
+        if (bytes == 0) {
+            // End of the file, or the pipe's last writer closed it
+            parseLines(buffer.data(), buffered, true);
+            break;
+        }
+
+        buffered += static_cast<size_t>(bytes);
+        const size_t consumed = parseLines(buffer.data(), buffered, false);
+        if (consumed == 0 && buffered == buffer.size()) {
+            // A line longer than the whole buffer can never be a record
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            buffered = 0;
+            continue;
+        }
+        std::memmove(buffer.data(), buffer.data() + consumed, buffered - consumed);
+        buffered -= consumed;
+    }
+
+    m_sourceDone.store(true, std::memory_order_release);
+}
@@ -0,0 +1,150 @@
+#include "ShaderCache.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+namespace {
+    constexpr uint32_t ENTRY_MAGIC = 0x42504757;    // "WGPB"
+    constexpr uint32_t ENTRY_VERSION = 1;
+
+    struct EntryHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;    // driver-specific binary format enum
+        uint32_t length;
+    };
+
+    // FNV-1a; the terminator is hashed too so stage boundaries count
+    uint64_t hashString(uint64_t hash, const char* text) {
+        for (const char* p = text; ; p++) {
+            hash ^= static_cast<uint8_t>(*p);
+            hash *= 0x100000001B3ull;
+            if (*p == '\0') return hash;
+        }
+    }
+
+    std::string glString(GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+ShaderCache::ShaderCache()
+    : m_enabled(false)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+void ShaderCache::initialize(const std::string& directory) {
+    m_enabled = false;
+    m_directory = directory;
+    if (directory.empty()) return;
+
+    GLint formats = 0;
+    if (GLAD_GL_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    if (formats <= 0) {
+        std::cout << "Shader cache unavailable: driver has no program binary formats\n";
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Shader cache unavailable: " << directory << ": " << error.message() << "\n";
+        return;
+    }
+
+    m_driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+    m_enabled = true;
+}
+
+uint64_t ShaderCache::key(const char* vertex, const char* geometry, const char* fragment) const {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = hashString(hash, m_driver.c_str());
+    hash = hashString(hash, vertex);
+    hash = hashString(hash, geometry ? geometry : "");
+    hash = hashString(hash, fragment);
+    return hash;
+}
+
+std::string ShaderCache::pathFor(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+GLuint ShaderCache::load(uint64_t key) {
+    if (!m_enabled) return 0;
+
+    FILE* file = std::fopen(pathFor(key).c_str(), "rb");
+    if (!file) {
+        m_misses++;
+        return 0;
+    }
+
+    EntryHeader header = {};
+    std::vector<char> binary;
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                 header.magic == ENTRY_MAGIC && header.version == ENTRY_VERSION && header.length > 0;
+    if (valid) {
+        binary.resize(header.length);
+        valid = std::fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    std::fclose(file);
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (program) {
+        m_hits++;
+    } else {
+        m_misses++;
+    }
+    return program;
+}
+
+void ShaderCache::store(uint64_t key, GLuint program) {
+    if (!m_enabled) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return;
+
+    // Written aside and renamed into place, so another instance starting
+    // at the same time never reads half an entry
+    const std::string path = pathFor(key);
+    const std::string partial = path + ".tmp";
+    FILE* file = std::fopen(partial.c_str(), "wb");
+    if (!file) return;
+
+    const EntryHeader header = {ENTRY_MAGIC, ENTRY_VERSION, format, static_cast<uint32_t>(written)};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(binary.data(), 1, written, file) == static_cast<size_t>(written);
+    ok = std::fclose(file) == 0 && ok;
+
+    std::error_code error;
+    if (ok) std::filesystem::rename(partial, path, error);
+    if (!ok || error) std::filesystem::remove(partial, error);
+}
@@ -0,0 +1,80 @@
+#include "ShaderProgram.hpp"
+#include <vector>
+
+ShaderProgram::ShaderProgram(GLuint program)
+    : m_program(program)
+{
+    cacheUniforms();
+}
+
+ShaderProgram::~ShaderProgram() {
+    destroy();
+}
+
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept
+    : m_program(other.m_program)
+    , m_uniforms(std::move(other.m_uniforms))
+{
+    other.m_program = 0;
+}
+
+ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept {
+    if (this != &other) {
+        destroy();
+        m_program = other.m_program;
+        m_uniforms = std::move(other.m_uniforms);
+        other.m_program = 0;
+    }
+    return *this;
+}
+
+void ShaderProgram::cacheUniforms() {
+    m_uniforms.clear();
+    if (!m_program) return;
+    
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    
+    std::vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_program, i, static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+        
+        std::string name(nameBuffer.data(), length);
+        GLint location = glGetUniformLocation(m_program, name.c_str());
+        if (location < 0) continue;  // member of a uniform block
+        
+        // Arrays report "name[0]"; make them reachable by the bare name too
+        size_t bracket = name.find('[');
+        if (bracket != std::string::npos) {
+            m_uniforms.emplace(name.substr(0, bracket), location);
+        }
+        m_uniforms.emplace(std::move(name), location);
+    }
+}
+
+GLint ShaderProgram::uniform(const std::string& name) const {
+    auto it = m_uniforms.find(name);
+    return it != m_uniforms.end() ? it->second : -1;
+}
+
+void ShaderProgram::bindUniformBlock(const char* name, GLuint binding) const {
+    if (!m_program) return;
+    
+    GLuint index = glGetUniformBlockIndex(m_program, name);
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(m_program, index, binding);
+    }
+}
+
+void ShaderProgram::destroy() {
+    if (m_program) {
+        glDeleteProgram(m_program);
+        m_program = 0;
+    }
+    m_uniforms.clear();
+}
@@ -0,0 +1,37 @@
+#include "ShaderWatcher.hpp"
+
+#include <system_error>
+#include <utility>
+
+void ShaderWatcher::watch(const std::string& directory) {
+    m_directory = directory;
+    m_times = scan();
+}
+
+bool ShaderWatcher::poll() {
+    if (m_directory.empty()) return false;
+
+    FileTimes times = scan();
+    if (times == m_times) return false;
+    m_times = std::move(times);
+    return true;
+}
+
+ShaderWatcher::FileTimes ShaderWatcher::scan() const {
+    namespace fs = std::filesystem;
+    FileTimes times;
+
+    // Editors that save through a temporary file can leave the directory
+    // briefly inconsistent; errors count as "no file" and settle next poll
+    std::error_code error;
+    for (fs::directory_iterator it(m_directory, error), end; !error && it != end; it.increment(error)) {
+        const fs::path& path = it->path();
+        const std::string extension = path.extension().string();
+        if (extension != ".vert" && extension != ".geom" && extension != ".frag") continue;
+
+        std::error_code timeError;
+        const fs::file_time_type time = fs::last_write_time(path, timeError);
+        if (!timeError) times.emplace(path.filename().string(), time);
+    }
+    return times;
+}
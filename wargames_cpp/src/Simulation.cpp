@@ -0,0 +1,249 @@
+#include "Simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    bool isRussiaOrJapanTarget(const LatLon& target) {
+        // Moscow check
+        const double MOSCOW_LAT = 55.7558;
+        const double MOSCOW_LON = 37.6173;
+        // Tokyo check
+        const double TOKYO_LAT = 35.6762;
+        const double TOKYO_LON = 139.6503;
+        const double EPSILON = 0.01;
+
+        bool isMoscow = std::abs(target.lat - MOSCOW_LAT) < EPSILON &&
+                        std::abs(target.lon - MOSCOW_LON) < EPSILON;
+        bool isTokyo = std::abs(target.lat - TOKYO_LAT) < EPSILON &&
+                       std::abs(target.lon - TOKYO_LON) < EPSILON;
+
+        return isMoscow || isTokyo;
+    }
+
+    Color getColorForTarget(const LatLon& target) {
+        // Red for Russian and Japanese targets only
+        if (isRussiaOrJapanTarget(target)) {
+            return Colors::RED;
+        }
+        // Cyan for all other targets
+        return Colors::CYAN;
+    }
+}
+
+Simulation::Simulation(const SimulationConfig& config, JobSystem* jobs)
+    : m_config(config)
+    , m_rng(config.seed)
+    , m_trajectories(jobs)
+    , m_missiles(m_trajectories, MISSILE_CAPACITY)
+    , m_feed(nullptr)
+    , m_feedTime(0.0)
+    , m_gpuTrailsSynced(false)
+    , m_tickSeconds(1.0 / std::max(1, config.tickHz))
+    , m_accumulator(0.0)
+    , m_time(0.0)
+    , m_launchInterval(config.launchInterval)
+    , m_timeSinceLastLaunch(config.launchInterval)
+    , m_timeSinceLastBurst(0.0f)
+    , m_missilesLaunched(0)
+{
+}
+
+int Simulation::randomInt(int min, int max) {
+    std::uniform_int_distribution<> dis(min, max);
+    return dis(m_rng);
+}
+
+float Simulation::randomFloat(float min, float max) {
+    std::uniform_real_distribution<float> dis(min, max);
+    return dis(m_rng);
+}
+
+LatLon Simulation::randomTarget() {
+    int idx = randomInt(0, TARGET_LOCATIONS.size() - 1);
+    return TARGET_LOCATIONS[idx];
+}
+
+LatLon Simulation::randomSubmarineStart() {
+    int idx = randomInt(0, SUBMARINE_POINTS.size() - 1);
+    return SUBMARINE_POINTS[idx];
+}
+
+LatLon Simulation::randomWesternTarget() {
+    int idx = randomInt(0, WESTERN_TARGETS.size() - 1);
+    return WESTERN_TARGETS[idx];
+}
+
+LatLon Simulation::randomEasternTarget() {
+    int idx = randomInt(0, EASTERN_TARGETS.size() - 1);
+    return EASTERN_TARGETS[idx];
+}
+
+void Simulation::initialize() {
+    // Every launch is drawn from these tables, so their paths are computed
+    // once up front and pinned
+    m_trajectories.prewarm(TARGET_LOCATIONS.data(), TARGET_LOCATIONS.size(),
+                           TARGET_LOCATIONS.data(), TARGET_LOCATIONS.size(), MissilePool::PATH_SAMPLES);
+    m_trajectories.prewarm(SUBMARINE_POINTS.data(), SUBMARINE_POINTS.size(),
+                           WESTERN_TARGETS.data(), WESTERN_TARGETS.size(), MissilePool::PATH_SAMPLES);
+    m_trajectories.prewarm(SUBMARINE_POINTS.data(), SUBMARINE_POINTS.size(),
+                           EASTERN_TARGETS.data(), EASTERN_TARGETS.size(), MissilePool::PATH_SAMPLES);
+
+    // Room for the uncached paths and impacts of a full missile pool
+    m_trajectories.reserve(m_trajectories.entryCount() + MISSILE_CAPACITY, MissilePool::PATH_SAMPLES);
+    m_impacts.reserve(MISSILE_CAPACITY);
+
+    // Every loop goes into one shared array, sized up front
+    m_aircraft.reserve(m_config.aircraftCount);
+    m_aircraftLoops.reserve(static_cast<size_t>(m_config.aircraftCount) * Aircraft::LOOP_SAMPLES);
+    for (int i = 0; i < m_config.aircraftCount; i++) {
+        float lat = randomFloat(-60.0f, 60.0f);
+        float lon = randomFloat(-180.0f, 180.0f);
+        float radius = randomFloat(3.0f, 12.0f);
+        float loopSeconds = randomFloat(20.0f, 60.0f);
+        m_aircraft.emplace_back(LatLon{lat, lon}, radius, loopSeconds, Colors::DIM_CYAN, m_aircraftLoops);
+    }
+
+    for (int i = 0; i < m_config.initialMissiles; i++) {
+        launchRandom();
+    }
+}
+
+void Simulation::attachFeed(ScenarioFeed* feed) {
+    m_feed = feed;
+    m_feedTime = 0.0;
+    m_feedEvents.clear();
+    m_feedEvents.reserve(MAX_FEED_LAUNCHES_PER_TICK);
+}
+
+void Simulation::launchRandom() {
+    // Randomly choose between regular missile and submarine missile
+    auto start = randomTarget();
+    auto end = randomTarget();
+
+    if (randomInt(0, 3) == 0) {
+        // Submarine missile (25% chance)
+        auto subStart = randomSubmarineStart();
+        auto subEnd = (randomInt(0, 1) == 0) ? randomEasternTarget() : randomWesternTarget();
+        auto color = getColorForTarget(subEnd);
+        m_missiles.spawn(MissileType::Submarine, subStart, subEnd, color);
+    } else {
+        // Regular missile
+        auto color = getColorForTarget(end);
+        m_missiles.spawn(MissileType::Silo, start, end, color);
+    }
+    m_missilesLaunched++;
+}
+
+void Simulation::launchBurst() {
+    // Burst mode: 5 regular missiles + 3 submarine missiles
+    for (int i = 0; i < 5; i++) {
+        auto start = randomTarget();
+        auto end = randomTarget();
+        auto color = getColorForTarget(end);
+        m_missiles.spawn(MissileType::Silo, start, end, color);
+    }
+    for (int i = 0; i < 3; i++) {
+        auto start = randomSubmarineStart();
+        auto end = (randomInt(0, 1) == 0) ? randomEasternTarget() : randomWesternTarget();
+        auto color = getColorForTarget(end);
+        m_missiles.spawn(MissileType::Submarine, start, end, color);
+    }
+    m_missilesLaunched += 8;
+}
+
+int Simulation::step(double seconds, const SimulationInput& input) {
+    m_launchInterval = input.launchInterval;
+    for (int i = 0; i < input.bursts; i++) {
+        launchBurst();
+    }
+
+    // A stall longer than MAX_TICKS_PER_STEP ticks drops the backlog
+    // instead of catching up
+    m_accumulator += seconds;
+    int ticks = 0;
+    while (m_accumulator >= m_tickSeconds && ticks < MAX_TICKS_PER_STEP) {
+        tick(static_cast<float>(m_tickSeconds));
+        m_accumulator -= m_tickSeconds;
+        ticks++;
+    }
+    if (ticks == MAX_TICKS_PER_STEP) m_accumulator = std::min(m_accumulator, m_tickSeconds);
+    return ticks;
+}
+
+void Simulation::tick(float dt) {
+    m_time += dt;
+
+    // Spawn missiles
+    if (m_feed) {
+        m_feedTime += dt;
+        m_feedEvents.clear();
+        m_feed->poll(m_feedTime, m_feedEvents, MAX_FEED_LAUNCHES_PER_TICK);
+        for (const LaunchEvent& event : m_feedEvents) {
+            m_missiles.spawn(event.type, event.start, event.end, getColorForTarget(event.end));
+        }
+        m_missilesLaunched += m_feedEvents.size();
+    } else {
+        m_timeSinceLastLaunch += dt;
+        if (m_timeSinceLastLaunch >= m_launchInterval) {
+            m_timeSinceLastLaunch = 0.0f;
+            launchRandom();
+        }
+    }
+
+    if (m_config.burstInterval > 0.0f) {
+        m_timeSinceLastBurst += dt;
+        if (m_timeSinceLastBurst >= m_config.burstInterval) {
+            m_timeSinceLastBurst = 0.0f;
+            launchBurst();
+        }
+    }
+
+    // Update aircraft
+    for (auto& craft : m_aircraft) {
+        craft.update(dt);
+    }
+
+    // Launch missiles whose trajectories finished on the workers
+    m_missiles.activatePending();
+
+    // Finished missiles are retired inside the pool; spawn explosions at their impacts
+    m_impacts.clear();
+    m_missiles.update(dt, m_impacts);
+    for (const auto& pos : m_impacts) {
+        m_explosions.spawn(pos.x, pos.y, Colors::CYAN);
+    }
+
+    // Update explosions; finished ones leave the pool
+    m_explosions.update(dt);
+}
+
+void Simulation::buildDrawList(DrawList& list, DrawList* trails, bool redrawTrails, bool gpuTrails) {
+    const float blend = alpha();
+
+    // Paths computed since the last list reach the GPU buffer with this one;
+    // after a spell without GPU trails the whole arena is sent again
+    if (gpuTrails && !trails) {
+        if (!m_gpuTrailsSynced) m_trajectories.markAllWritten();
+        const uint32_t begin = m_trajectories.writtenBegin();
+        list.submitTrailPoints(begin, m_trajectories.arenaData() + begin, m_trajectories.writtenEnd() - begin);
+        m_gpuTrailsSynced = true;
+    } else {
+        m_gpuTrailsSynced = false;
+    }
+    m_trajectories.clearWritten();
+
+    for (const auto& craft : m_aircraft) {
+        craft.draw(list, blend);
+    }
+
+    if (trails) {
+        m_missiles.drawPersistent(list, *trails, blend, redrawTrails);
+    } else if (gpuTrails) {
+        m_missiles.drawGpu(list, blend);
+    } else {
+        m_missiles.draw(list, blend);
+    }
+
+    m_explosions.draw(list, blend);
+}
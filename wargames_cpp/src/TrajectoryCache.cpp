@@ -0,0 +1,337 @@
+#include "TrajectoryCache.hpp"
+#include "JobSystem.hpp"
+#include <GeographicLib/Geodesic.hpp>
+#include <GeographicLib/GeodesicLine.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace GeographicLib;
+
+namespace {
+    // Result buffers for async requests; the completion queue has a cell
+    // for each, so a worker's push cannot fail
+    constexpr size_t ASYNC_SLOT_COUNT = 1024;
+    
+    // Lookup table slots before the first rehash; a power of two
+    constexpr size_t INITIAL_TABLE_SIZE = 1024;
+}
+
+TrajectoryCache::TrajectoryCache(JobSystem* jobs)
+    : m_table(INITIAL_TABLE_SIZE, INVALID_HANDLE),
+      m_jobs(jobs),
+      m_slots(jobs ? ASYNC_SLOT_COUNT : 0),
+      m_completed(ASYNC_SLOT_COUNT) {
+    m_freeSlots.reserve(m_slots.size());
+    for (size_t slot = m_slots.size(); slot-- > 0; ) {
+        m_freeSlots.push_back(static_cast<uint32_t>(slot));
+    }
+}
+
+TrajectoryCache::~TrajectoryCache() {
+    // Outstanding jobs reference m_slots and m_completed; let them bail out and finish
+    if (m_jobs) {
+        m_shuttingDown.store(true, std::memory_order_relaxed);
+        m_jobs->waitIdle();
+    }
+}
+
+TrajectoryCache::Key TrajectoryCache::makeKey(const LatLon& start, const LatLon& end, int samples) {
+    return Key{start.lat, start.lon, end.lat, end.lon, samples < 2 ? 2 : samples};
+}
+
+size_t TrajectoryCache::KeyHash::operator()(const Key& key) const {
+    std::hash<double> hashDouble;
+    size_t h = std::hash<int>()(key.samples);
+    for (double v : {key.startLat, key.startLon, key.endLat, key.endLon}) {
+        h ^= hashDouble(v) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+void TrajectoryCache::calculatePath(const LatLon& start, const LatLon& end, int samples, Point* out) {
+    const Geodesic& geod = Geodesic::WGS84();
+    
+    // Calculate geodesic line
+    double s12, azi1, azi2;
+    geod.Inverse(start.lat, start.lon, end.lat, end.lon, s12, azi1, azi2);
+    
+    GeodesicLine line = geod.Line(start.lat, start.lon, azi1);
+    
+    for (int i = 0; i < samples; i++) {
+        double t = static_cast<double>(i) / (samples - 1);
+        double lat, lon;
+        line.Position(t * s12, lat, lon);
+        
+        out[i] = lonlat_to_world(lon, lat);
+    }
+}
+
+TrajectoryCache::Handle TrajectoryCache::find(const Key& key) const {
+    const size_t mask = m_table.size() - 1;
+    for (size_t i = KeyHash()(key) & mask; m_table[i] != INVALID_HANDLE; i = (i + 1) & mask) {
+        if (m_entries[m_table[i]].key == key) return m_table[i];
+    }
+    return INVALID_HANDLE;
+}
+
+void TrajectoryCache::insert(Handle handle) {
+    if (m_entries.size() * 2 > m_table.size()) {
+        rehash(m_table.size() * 2);
+        return;     // rehash() placed every entry, this one included
+    }
+    
+    const size_t mask = m_table.size() - 1;
+    size_t i = KeyHash()(m_entries[handle].key) & mask;
+    while (m_table[i] != INVALID_HANDLE) i = (i + 1) & mask;
+    m_table[i] = handle;
+}
+
+void TrajectoryCache::erase(const Key& key) {
+    const size_t mask = m_table.size() - 1;
+    size_t hole = KeyHash()(key) & mask;
+    while (m_table[hole] != INVALID_HANDLE && !(m_entries[m_table[hole]].key == key)) {
+        hole = (hole + 1) & mask;
+    }
+    if (m_table[hole] == INVALID_HANDLE) return;
+    
+    // Shift later members of the probe run back over the hole, so lookups
+    // never stop early at an empty slot
+    for (size_t i = (hole + 1) & mask; m_table[i] != INVALID_HANDLE; i = (i + 1) & mask) {
+        const size_t home = KeyHash()(m_entries[m_table[i]].key) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            m_table[hole] = m_table[i];
+            hole = i;
+        }
+    }
+    m_table[hole] = INVALID_HANDLE;
+}
+
+void TrajectoryCache::rehash(size_t tableSize) {
+    m_table.assign(tableSize, INVALID_HANDLE);
+    
+    const size_t mask = tableSize - 1;
+    for (Handle handle = 0; handle < m_entries.size(); handle++) {
+        size_t i = KeyHash()(m_entries[handle].key) & mask;
+        while (m_table[i] != INVALID_HANDLE) i = (i + 1) & mask;
+        m_table[i] = handle;
+    }
+}
+
+TrajectoryCache::ReclaimList& TrajectoryCache::reclaimList(uint32_t count) {
+    // Paths come in a handful of lengths at most
+    for (ReclaimList& list : m_reclaim) {
+        if (list.count == count) return list;
+    }
+    m_reclaim.push_back({count, INVALID_HANDLE, INVALID_HANDLE});
+    return m_reclaim.back();
+}
+
+TrajectoryCache::Handle TrajectoryCache::allocate(const Key& key) {
+    const uint32_t count = static_cast<uint32_t>(key.samples);
+    
+    // Reuse the oldest unreferenced block of the same length if there is one
+    ReclaimList& list = reclaimList(count);
+    while (list.head != INVALID_HANDLE) {
+        Handle handle = list.head;
+        Entry& entry = m_entries[handle];
+        list.head = entry.nextReclaim;
+        if (list.head == INVALID_HANDLE) list.tail = INVALID_HANDLE;
+        
+        entry.reclaimable = false;
+        entry.nextReclaim = INVALID_HANDLE;
+        if (entry.refs > 0 || entry.pinned) continue;   // revived since it was queued
+        
+        erase(entry.key);
+        entry.key = key;
+        insert(handle);
+        return handle;
+    }
+    
+    Handle handle = static_cast<Handle>(m_entries.size());
+    m_entries.push_back({key, static_cast<uint32_t>(m_arena.size()), count, 0, {}, 0, {},
+                         false, false, false, INVALID_HANDLE});
+    m_arena.resize(m_arena.size() + count);
+    insert(handle);
+    return handle;
+}
+
+void TrajectoryCache::computePath(Entry& entry) {
+    calculatePath(LatLon(entry.key.startLat, entry.key.startLon), LatLon(entry.key.endLat, entry.key.endLon),
+                  entry.key.samples, &m_arena[entry.offset]);
+    analyzePath(entry);
+    noteWritten(entry);
+}
+
+void TrajectoryCache::analyzePath(Entry& entry) const {
+    const Point* path = &m_arena[entry.offset];
+    entry.breakCount = 0;
+    entry.bounds = Bounds{path[0].x, path[0].y, path[0].x, path[0].y};
+    
+    for (uint32_t i = 1; i < entry.count; i++) {
+        float dx = std::abs(path[i].x - path[i - 1].x);
+        if (dx > WORLD_WIDTH * 0.5f && entry.breakCount < MAX_BREAKS) {
+            entry.breaks[entry.breakCount++] = i;
+        }
+        entry.bounds.minX = std::min(entry.bounds.minX, path[i].x);
+        entry.bounds.minY = std::min(entry.bounds.minY, path[i].y);
+        entry.bounds.maxX = std::max(entry.bounds.maxX, path[i].x);
+        entry.bounds.maxY = std::max(entry.bounds.maxY, path[i].y);
+    }
+}
+
+void TrajectoryCache::noteWritten(const Entry& entry) {
+    m_writtenBegin = std::min(m_writtenBegin, entry.offset);
+    m_writtenEnd = std::max(m_writtenEnd, entry.offset + entry.count);
+}
+
+void TrajectoryCache::clearWritten() {
+    m_writtenBegin = 0xFFFFFFFFu;
+    m_writtenEnd = 0;
+}
+
+void TrajectoryCache::markAllWritten() {
+    m_writtenBegin = 0;
+    m_writtenEnd = static_cast<uint32_t>(m_arena.size());
+}
+
+TrajectoryCache::Handle TrajectoryCache::acquire(const LatLon& start, const LatLon& end, int samples) {
+    const Key key = makeKey(start, end, samples);
+    
+    Handle handle = find(key);
+    if (handle == INVALID_HANDLE) {
+        handle = allocate(key);
+        computePath(m_entries[handle]);
+    } else if (m_entries[handle].pending) {
+        // Wanted before its worker finished; collectCompleted() drops the result
+        m_entries[handle].pending = false;
+        computePath(m_entries[handle]);
+    }
+    
+    m_entries[handle].refs++;
+    return handle;
+}
+
+TrajectoryCache::Handle TrajectoryCache::tryAcquire(const LatLon& start, const LatLon& end, int samples) {
+    Handle handle = find(makeKey(start, end, samples));
+    if (handle == INVALID_HANDLE || m_entries[handle].pending) return INVALID_HANDLE;
+    
+    m_entries[handle].refs++;
+    return handle;
+}
+
+bool TrajectoryCache::requestAsync(const LatLon& start, const LatLon& end, int samples) {
+    if (!m_jobs) return false;
+    
+    const Key key = makeKey(start, end, samples);
+    if (find(key) != INVALID_HANDLE) return true;
+    if (m_freeSlots.empty()) return false;
+    
+    const uint32_t slotIndex = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    
+    AsyncSlot& slot = m_slots[slotIndex];
+    slot.key = key;
+    if (slot.points.size() < static_cast<size_t>(key.samples)) {
+        slot.points.resize(key.samples);
+    }
+    
+    // Keyed now so repeated requests for the path find it in flight
+    m_entries[allocate(key)].pending = true;
+    
+    // Captures fit std::function's inline storage, so submitting the job
+    // does not allocate either
+    m_jobs->submit([this, slotIndex]() {
+        if (m_shuttingDown.load(std::memory_order_relaxed)) return;
+        
+        AsyncSlot& slot = m_slots[slotIndex];
+        calculatePath(LatLon(slot.key.startLat, slot.key.startLon), LatLon(slot.key.endLat, slot.key.endLon),
+                      slot.key.samples, slot.points.data());
+        
+        // Never more slots than queue cells, so there is always room
+        uint32_t index = slotIndex;
+        m_completed.tryPush(std::move(index));
+    });
+    return true;
+}
+
+size_t TrajectoryCache::collectCompleted(std::vector<Handle>& ready) {
+    size_t collected = 0;
+    uint32_t slotIndex;
+    
+    while (m_completed.tryPop(slotIndex)) {
+        const AsyncSlot& slot = m_slots[slotIndex];
+        
+        Handle handle = find(slot.key);
+        bool store = true;
+        if (handle == INVALID_HANDLE) {
+            // Computed synchronously, released and recycled in the meantime
+            handle = allocate(slot.key);
+        } else if (m_entries[handle].pending) {
+            m_entries[handle].pending = false;
+        } else {
+            // Computed synchronously while the job was running
+            store = false;
+        }
+        
+        Entry& entry = m_entries[handle];
+        if (store) {
+            std::copy(slot.points.begin(), slot.points.begin() + entry.count, m_arena.begin() + entry.offset);
+            analyzePath(entry);
+            noteWritten(entry);
+        }
+        m_freeSlots.push_back(slotIndex);
+        
+        entry.refs++;
+        ready.push_back(handle);
+        collected++;
+    }
+    
+    return collected;
+}
+
+void TrajectoryCache::release(Handle handle) {
+    if (handle == INVALID_HANDLE) return;
+    
+    Entry& entry = m_entries[handle];
+    if (entry.refs > 0) entry.refs--;
+    
+    if (entry.refs == 0 && !entry.pinned && !entry.reclaimable) {
+        entry.reclaimable = true;
+        
+        ReclaimList& list = reclaimList(entry.count);
+        if (list.tail == INVALID_HANDLE) {
+            list.head = handle;
+        } else {
+            m_entries[list.tail].nextReclaim = handle;
+        }
+        list.tail = handle;
+    }
+}
+
+void TrajectoryCache::reserve(size_t paths, int samples) {
+    const uint32_t count = static_cast<uint32_t>(samples < 2 ? 2 : samples);
+    
+    m_entries.reserve(paths);
+    m_arena.reserve(paths * count);
+    reclaimList(count);
+    
+    size_t tableSize = m_table.size();
+    while (paths * 2 > tableSize) tableSize *= 2;
+    if (tableSize != m_table.size()) rehash(tableSize);
+    
+    // Slots a worker holds are left alone; they grow when next requested
+    for (uint32_t slotIndex : m_freeSlots) {
+        if (m_slots[slotIndex].points.size() < count) m_slots[slotIndex].points.resize(count);
+    }
+}
+
+void TrajectoryCache::prewarm(const LatLon* starts, size_t startCount, const LatLon* ends, size_t endCount, int samples) {
+    for (size_t i = 0; i < startCount; i++) {
+        for (size_t j = 0; j < endCount; j++) {
+            Handle handle = acquire(starts[i], ends[j], samples);
+            m_entries[handle].pinned = true;
+            m_entries[handle].refs--;
+        }
+    }
+}
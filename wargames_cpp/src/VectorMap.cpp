@@ -1,17 +1,251 @@
 #include "VectorMap.hpp"
+#include "GeoKernels.hpp"
 #include <shapefil.h>
 #include <iostream>
+#include <fstream>
+#include <filesystem>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr float VectorMap::LOD_TOLERANCES[VectorMap::LOD_LEVELS];
+constexpr int VectorMap::GRID_COLUMNS;
+constexpr int VectorMap::GRID_ROWS;
+
+namespace {
+    // Largest simplification error allowed on screen, in pixels
+    constexpr float MAX_PIXEL_ERROR = 0.5f;
+    
+    float segmentDistance(const Point& p, const Point& a, const Point& b) {
+        float dx = b.x - a.x;
+        float dy = b.y - a.y;
+        float lengthSq = dx * dx + dy * dy;
+        if (lengthSq <= 0.0f) {
+            // Closed rings start and end on the same point
+            return distance(p.x, p.y, a.x, a.y);
+        }
+        float t = clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSq, 0.0f, 1.0f);
+        return distance(p.x, p.y, a.x + t * dx, a.y + t * dy);
+    }
+    
+    // Iterative Douglas-Peucker; always keeps both end points
+    void simplifyPath(const Point* points, size_t count, float tolerance, std::vector<Point>& output) {
+        output.clear();
+        if (count < 3 || tolerance <= 0.0f) {
+            output.assign(points, points + count);
+            return;
+        }
+        
+        std::vector<bool> keep(count, false);
+        keep[0] = true;
+        keep[count - 1] = true;
+        
+        std::vector<std::pair<size_t, size_t>> stack;
+        stack.emplace_back(0, count - 1);
+        while (!stack.empty()) {
+            auto [first, last] = stack.back();
+            stack.pop_back();
+            
+            float maxDist = 0.0f;
+            size_t index = first;
+            for (size_t i = first + 1; i < last; i++) {
+                float d = segmentDistance(points[i], points[first], points[last]);
+                if (d > maxDist) {
+                    maxDist = d;
+                    index = i;
+                }
+            }
+            
+            if (maxDist > tolerance) {
+                keep[index] = true;
+                if (index - first > 1) stack.emplace_back(first, index);
+                if (last - index > 1) stack.emplace_back(index, last);
+            }
+        }
+        
+        for (size_t i = 0; i < count; i++) {
+            if (keep[i]) output.push_back(points[i]);
+        }
+    }
+    
+    constexpr char CACHE_MAGIC[8] = {'W', 'G', 'M', 'A', 'P', 'C', '\0', '\0'};
+    constexpr uint32_t CACHE_VERSION = 3;
+    constexpr uint32_t CACHE_LAYERS = 3;
+    
+    static_assert(sizeof(Point) == 2 * sizeof(float), "Point is uploaded as raw vec2 data");
+    static_assert(sizeof(Bounds) == 4 * sizeof(float), "Bounds are cached as raw float data");
+    static_assert(sizeof(GLint) == sizeof(int32_t) && sizeof(GLsizei) == sizeof(int32_t),
+                  "cache stores ranges as 32-bit integers");
+    
+    struct SourceStamp {
+        uint64_t size;
+        int64_t mtime;
+    };
+    
+    bool stampSource(const std::string& path, SourceStamp& stamp) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        stamp.size = fs::file_size(path, ec);
+        if (ec) return false;
+        stamp.mtime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+        return !ec;
+    }
+    
+    // Read-only view of a whole file, memory mapped where available
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    m_data = static_cast<const unsigned char*>(addr);
+                    m_size = static_cast<size_t>(st.st_size);
+                }
+            }
+            close(fd);
+#else
+            std::ifstream file(path, std::ios::binary);
+            if (!file) return;
+            m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            m_data = reinterpret_cast<const unsigned char*>(m_buffer.data());
+            m_size = m_buffer.size();
+#endif
+        }
+        
+        ~MappedFile() {
+#ifndef _WIN32
+            if (m_data) munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+        }
+        
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        
+        const unsigned char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+        
+    private:
+        const unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        std::vector<char> m_buffer;
+#endif
+    };
+    
+    // Bounds-checked cursor over the mapped cache
+    class CacheReader {
+    public:
+        CacheReader(const unsigned char* data, size_t size) : m_data(data), m_size(size), m_offset(0) {}
+        
+        template <typename T>
+        const T* take(size_t count) {
+            size_t bytes = count * sizeof(T);
+            if (bytes > m_size - m_offset) return nullptr;
+            const T* ptr = reinterpret_cast<const T*>(m_data + m_offset);
+            m_offset += bytes;
+            return ptr;
+        }
+        
+        template <typename T>
+        bool read(T& value) {
+            const T* ptr = take<T>(1);
+            if (!ptr) return false;
+            std::memcpy(&value, ptr, sizeof(T));
+            return true;
+        }
+        
+        bool atEnd() const { return m_offset == m_size; }
+        
+    private:
+        const unsigned char* m_data;
+        size_t m_size;
+        size_t m_offset;
+    };
+    
+    // A level's draw ranges must stay inside the layer's vertices; they go
+    // to glMultiDrawArrays unchecked
+    bool validRanges(const GLint* firsts, const GLsizei* counts, uint32_t rangeCount, uint32_t pointCount) {
+        for (uint32_t i = 0; i < rangeCount; i++) {
+            if (firsts[i] < 0 || counts[i] < 0 ||
+                static_cast<int64_t>(firsts[i]) + counts[i] > static_cast<int64_t>(pointCount)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    template <typename T>
+    void writeValue(std::ofstream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    
+    template <typename T>
+    void writeArray(std::ofstream& out, const std::vector<T>& values) {
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+    
+    // Small features get coarser detail regardless of zoom
+    int levelForExtent(float extentPixels) {
+        if (extentPixels < 4.0f) return 3;
+        if (extentPixels < 16.0f) return 2;
+        if (extentPixels < 64.0f) return 1;
+        return 0;
+    }
+    
+    int gridColumn(float x, int columns) {
+        int column = static_cast<int>(std::floor((x + WORLD_WIDTH * 0.5f) / WORLD_WIDTH * columns));
+        return std::clamp(column, 0, columns - 1);
+    }
+    
+    int gridRow(float y, int rows) {
+        int row = static_cast<int>(std::floor((y + WORLD_HEIGHT * 0.5f) / WORLD_HEIGHT * rows));
+        return std::clamp(row, 0, rows - 1);
+    }
+}
 
 VectorMap::VectorMap(Renderer* renderer)
     : m_renderer(renderer)
+    , m_activeView(0)
 {
+    setViewCount(1);
+    m_coastlines.color = Colors::DIM_CYAN;
+    m_borders.color = Colors::DARKER_CYAN;
+    m_russiaBorders.color = Colors::RED;
 }
 
 VectorMap::~VectorMap() {
+    m_renderer->destroyStaticLines(m_coastlines.gpu);
+    m_renderer->destroyStaticLines(m_borders.gpu);
+    m_renderer->destroyStaticLines(m_russiaBorders.gpu);
 }
 
 bool VectorMap::loadShapefiles(const std::string& coastlinePath, const std::string& countriesPath) {
+    const std::string countriesDbf = std::filesystem::path(countriesPath).replace_extension(".dbf").string();
+    const std::vector<std::string> sources = {coastlinePath, countriesPath, countriesDbf};
+    const std::string cachePath = cachePathFor(coastlinePath);
+    
+    if (loadCache(cachePath, sources)) {
+        std::cout << "Loaded map cache: " << cachePath << "\n";
+        return true;
+    }
+    
+    // Discard anything a partially valid cache left behind
+    clearLayer(m_coastlines);
+    clearLayer(m_borders);
+    clearLayer(m_russiaBorders);
+    
     bool success = true;
     
     if (!loadCoastlines(coastlinePath)) {
@@ -24,9 +258,153 @@ bool VectorMap::loadShapefiles(const std::string& coastlinePath, const std::stri
         success = false;
     }
     
+    buildLevelsOfDetail(m_coastlines);
+    buildLevelsOfDetail(m_borders);
+    buildLevelsOfDetail(m_russiaBorders);
+    
+    if (success && writeCache(cachePath, sources)) {
+        std::cout << "Wrote map cache: " << cachePath << "\n";
+    }
+    
+    // The map never changes after loading, so it lives on the GPU from here on
+    uploadLayer(m_coastlines);
+    uploadLayer(m_borders);
+    uploadLayer(m_russiaBorders);
+    
     return success;
 }
 
+std::string VectorMap::cachePathFor(const std::string& coastlinePath) {
+    return (std::filesystem::path(coastlinePath).parent_path() / "wargames_map.cache").string();
+}
+
+bool VectorMap::loadCache(const std::string& cachePath, const std::vector<std::string>& sources) {
+    MappedFile file(cachePath);
+    if (!file.data()) return false;
+    
+    CacheReader reader(file.data(), file.size());
+    
+    const char* magic = reader.take<char>(sizeof(CACHE_MAGIC));
+    uint32_t version = 0, levels = 0, sourceCount = 0, layerCount = 0;
+    if (!magic || std::memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        !reader.read(version) || version != CACHE_VERSION ||
+        !reader.read(levels) || levels != LOD_LEVELS ||
+        !reader.read(sourceCount) || sourceCount != sources.size() ||
+        !reader.read(layerCount) || layerCount != CACHE_LAYERS) {
+        return false;
+    }
+    
+    const float* tolerances = reader.take<float>(LOD_LEVELS);
+    if (!tolerances || std::memcmp(tolerances, LOD_TOLERANCES, sizeof(LOD_TOLERANCES)) != 0) {
+        return false;
+    }
+    
+    for (const auto& source : sources) {
+        SourceStamp cached, current;
+        if (!reader.read(cached) || !stampSource(source, current) ||
+            cached.size != current.size || cached.mtime != current.mtime) {
+            std::cout << "Map cache is stale, rebuilding from shapefiles\n";
+            return false;
+        }
+    }
+    
+    for (MapLayer* layer : {&m_coastlines, &m_borders, &m_russiaBorders}) {
+        uint32_t segmentCount = 0, pointCount = 0;
+        Color color;
+        if (!reader.read(segmentCount) || !reader.read(pointCount) || !reader.read(color)) {
+            return false;
+        }
+        
+        const Point* points = reader.take<Point>(pointCount);
+        if (!points) return false;
+        
+        layer->color = color;
+        layer->points.clear();
+        for (int level = 0; level < LOD_LEVELS; level++) {
+            const GLint* firsts = reader.take<GLint>(segmentCount);
+            const GLsizei* counts = reader.take<GLsizei>(segmentCount);
+            if (!firsts || !counts || !validRanges(firsts, counts, segmentCount, pointCount)) {
+                std::cout << "Map cache is corrupt, rebuilding from shapefiles\n";
+                return false;
+            }
+            layer->firsts[level].assign(firsts, firsts + segmentCount);
+            layer->counts[level].assign(counts, counts + segmentCount);
+        }
+        const Bounds* bounds = reader.take<Bounds>(segmentCount);
+        if (!bounds) return false;
+        layer->bounds.assign(bounds, bounds + segmentCount);
+        buildSpatialIndex(*layer);
+        
+        // Vertices go straight from the mapping into the GPU buffer
+        if (pointCount > 0 && !m_renderer->createStaticLines(layer->gpu, points, pointCount)) {
+            return false;
+        }
+        selectLevelsOfDetail(*layer);
+    }
+    
+    return reader.atEnd();
+}
+
+bool VectorMap::writeCache(const std::string& cachePath, const std::vector<std::string>& sources) const {
+    std::vector<SourceStamp> stamps(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (!stampSource(sources[i], stamps[i])) return false;
+    }
+    
+    // The reader takes each level as one range per segment
+    for (const MapLayer* layer : {&m_coastlines, &m_borders, &m_russiaBorders}) {
+        for (int level = 0; level < LOD_LEVELS; level++) {
+            if (layer->firsts[level].size() != layer->bounds.size() ||
+                layer->counts[level].size() != layer->bounds.size()) {
+                return false;
+            }
+        }
+    }
+    
+    // Write beside the target and rename, so a crash never leaves a torn cache
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write map cache: " << tempPath << "\n";
+            return false;
+        }
+        
+        out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        writeValue(out, CACHE_VERSION);
+        writeValue(out, static_cast<uint32_t>(LOD_LEVELS));
+        writeValue(out, static_cast<uint32_t>(sources.size()));
+        writeValue(out, CACHE_LAYERS);
+        out.write(reinterpret_cast<const char*>(LOD_TOLERANCES), sizeof(LOD_TOLERANCES));
+        writeArray(out, stamps);
+        
+        for (const MapLayer* layer : {&m_coastlines, &m_borders, &m_russiaBorders}) {
+            writeValue(out, static_cast<uint32_t>(layer->bounds.size()));
+            writeValue(out, static_cast<uint32_t>(layer->points.size()));
+            writeValue(out, layer->color);
+            writeArray(out, layer->points);
+            for (int level = 0; level < LOD_LEVELS; level++) {
+                writeArray(out, layer->firsts[level]);
+                writeArray(out, layer->counts[level]);
+            }
+            writeArray(out, layer->bounds);
+        }
+        
+        if (!out) {
+            std::cerr << "Failed writing map cache: " << tempPath << "\n";
+            return false;
+        }
+    }
+    
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
 bool VectorMap::loadCoastlines(const std::string& path) {
     SHPHandle hSHP = SHPOpen(path.c_str(), "rb");
     if (!hSHP) {
@@ -48,16 +426,7 @@ bool VectorMap::loadCoastlines(const std::string& path) {
             int startIdx = psShape->panPartStart[part];
             int endIdx = (part + 1 < psShape->nParts) ? psShape->panPartStart[part + 1] : psShape->nVertices;
             
-            std::vector<Point> points;
-            for (int j = startIdx; j < endIdx; j++) {
-                double lon = psShape->padfX[j];
-                double lat = psShape->padfY[j];
-                points.push_back(lonlat_to_xy(lon, lat, SCREEN_WIDTH, SCREEN_HEIGHT));
-            }
-            
-            if (!points.empty()) {
-                 splitAtAntimeridian(points, m_coastlines, Colors::DIM_CYAN);
-            }
+            appendPart(psShape->padfX + startIdx, psShape->padfY + startIdx, endIdx - startIdx, m_coastlines);
         }
         
         SHPDestroyObject(psShape);
@@ -106,24 +475,14 @@ bool VectorMap::loadCountries(const std::string& path) {
             }
         }
         
-        Color borderColor = isRedCountry ? Colors::RED : Colors::DARKER_CYAN;
-        auto& targetVector = isRedCountry ? m_russiaBorders : m_borders;
+        auto& targetLayer = isRedCountry ? m_russiaBorders : m_borders;
         
         // Process each part of the shape
         for (int part = 0; part < psShape->nParts; part++) {
             int startIdx = psShape->panPartStart[part];
             int endIdx = (part + 1 < psShape->nParts) ? psShape->panPartStart[part + 1] : psShape->nVertices;
             
-            std::vector<Point> points;
-            for (int j = startIdx; j < endIdx; j++) {
-                double lon = psShape->padfX[j];
-                double lat = psShape->padfY[j];
-                points.push_back(lonlat_to_xy(lon, lat, SCREEN_WIDTH, SCREEN_HEIGHT));
-            }
-            
-            if (!points.empty()) {
-                splitAtAntimeridian(points, targetVector, borderColor);
-            }
+            appendPart(psShape->padfX + startIdx, psShape->padfY + startIdx, endIdx - startIdx, targetLayer);
         }
         
         SHPDestroyObject(psShape);
@@ -134,52 +493,279 @@ bool VectorMap::loadCountries(const std::string& path) {
     return true;
 }
 
-void VectorMap::splitAtAntimeridian(const std::vector<Point>& points, std::vector<LineSegment>& output, const Color& color) {
-    if (points.empty()) return;
+void VectorMap::appendPart(const double* lon, const double* lat, size_t count, MapLayer& output) {
+    if (count == 0) return;
+    
+    // Shapefiles store coordinates as separate x and y arrays, which the
+    // kernel projects straight into the layer's interleaved point array
+    const size_t first = output.points.size();
+    output.points.resize(first + count);
+    GeoKernels::projectPoints(lon, lat, count, output.points.data() + first);
+    splitAtAntimeridian(output, first);
+}
+
+void VectorMap::splitAtAntimeridian(MapLayer& output, size_t first) {
+    const size_t count = output.points.size() - first;
+    if (count == 0) return;
+    
+    Point* points = output.points.data() + first;
+    m_splitBreaks.resize(count);
+    const size_t breakCount = GeoKernels::findAntimeridianBreaks(points, count, m_splitBreaks.data());
+    
+    // Runs between breaks become strips, compacted in place; single points
+    // cannot be drawn as a strip and are dropped
+    size_t kept = 0;
+    size_t runStart = 0;
+    for (size_t b = 0; b <= breakCount; b++) {
+        const size_t runEnd = (b < breakCount) ? m_splitBreaks[b] : count;
+        const size_t length = runEnd - runStart;
+        if (length > 1) {
+            if (kept != runStart) {
+                std::memmove(points + kept, points + runStart, length * sizeof(Point));
+            }
+            output.firsts[0].push_back(static_cast<GLint>(first + kept));
+            output.counts[0].push_back(static_cast<GLsizei>(length));
+            kept += length;
+        }
+        runStart = runEnd;
+    }
+    output.points.resize(first + kept);
+}
+
+void VectorMap::clearLayer(MapLayer& layer) {
+    layer.points.clear();
+    for (int level = 0; level < LOD_LEVELS; level++) {
+        layer.firsts[level].clear();
+        layer.counts[level].clear();
+    }
+    layer.bounds.clear();
+    layer.cellStarts.clear();
+    layer.cellSegments.clear();
+    layer.visited.clear();
+    for (auto& ranges : layer.drawn) {
+        ranges.firsts.clear();
+        ranges.counts.clear();
+    }
+    m_renderer->destroyStaticLines(layer.gpu);
+}
+
+void VectorMap::buildLevelsOfDetail(MapLayer& layer) {
+    const size_t segmentCount = layer.firsts[0].size();
+    const size_t sourceVertices = layer.points.size();
+    
+    layer.bounds.resize(segmentCount);
+    for (int level = 1; level < LOD_LEVELS; level++) {
+        layer.firsts[level].resize(segmentCount);
+        layer.counts[level].resize(segmentCount);
+    }
+    
+    std::vector<Point> source;
+    std::vector<Point> simplified;
+    for (size_t s = 0; s < segmentCount; s++) {
+        // Copy out first: appending the coarser levels may reallocate points
+        auto begin = layer.points.begin() + layer.firsts[0][s];
+        source.assign(begin, begin + layer.counts[0][s]);
+        
+        float minX = source[0].x, maxX = source[0].x;
+        float minY = source[0].y, maxY = source[0].y;
+        for (const auto& p : source) {
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
+        }
+        layer.bounds[s] = Bounds{minX, minY, maxX, maxY};
+        
+        for (int level = 1; level < LOD_LEVELS; level++) {
+            simplifyPath(source.data(), source.size(), LOD_TOLERANCES[level], simplified);
+            layer.firsts[level][s] = static_cast<GLint>(layer.points.size());
+            layer.counts[level][s] = static_cast<GLsizei>(simplified.size());
+            layer.points.insert(layer.points.end(), simplified.begin(), simplified.end());
+        }
+    }
+    
+    size_t coarseVertices = 0;
+    for (GLsizei count : layer.counts[LOD_LEVELS - 1]) {
+        coarseVertices += count;
+    }
+    std::cout << "Map LOD: " << sourceVertices << " source vertices, "
+              << coarseVertices << " at coarsest level\n";
+    
+    buildSpatialIndex(layer);
+    selectLevelsOfDetail(layer);
+}
+
+void VectorMap::buildSpatialIndex(MapLayer& layer) {
+    const size_t segmentCount = layer.bounds.size();
+    const size_t cellCount = static_cast<size_t>(GRID_COLUMNS) * GRID_ROWS;
+    
+    // Two passes: count per cell, then fill the prefix-summed ranges
+    layer.cellStarts.assign(cellCount + 1, 0);
+    auto forEachCell = [](const Bounds& b, auto&& fn) {
+        const int column0 = gridColumn(b.minX, GRID_COLUMNS);
+        const int column1 = gridColumn(b.maxX, GRID_COLUMNS);
+        const int row0 = gridRow(b.minY, GRID_ROWS);
+        const int row1 = gridRow(b.maxY, GRID_ROWS);
+        for (int row = row0; row <= row1; row++) {
+            for (int column = column0; column <= column1; column++) {
+                fn(static_cast<size_t>(row) * GRID_COLUMNS + column);
+            }
+        }
+    };
+    
+    for (const Bounds& b : layer.bounds) {
+        forEachCell(b, [&](size_t cell) { layer.cellStarts[cell + 1]++; });
+    }
+    for (size_t cell = 0; cell < cellCount; cell++) {
+        layer.cellStarts[cell + 1] += layer.cellStarts[cell];
+    }
     
-    std::vector<Point> currentSegment;
-    currentSegment.push_back(points[0]);
+    layer.cellSegments.resize(layer.cellStarts[cellCount]);
+    std::vector<uint32_t> cursor(layer.cellStarts.begin(), layer.cellStarts.end() - 1);
+    for (size_t s = 0; s < segmentCount; s++) {
+        forEachCell(layer.bounds[s], [&](size_t cell) {
+            layer.cellSegments[cursor[cell]++] = static_cast<uint32_t>(s);
+        });
+    }
     
-    for (size_t i = 1; i < points.size(); i++) {
-        if (crossesAntimeridian(points[i-1], points[i])) {
-            // Save current segment
-            if (currentSegment.size() > 1) {
-                output.push_back({currentSegment, color});
+    layer.visited.assign(segmentCount, 0);
+    layer.visitStamp = 0;
+}
+
+void VectorMap::selectLevelsOfDetail(MapLayer& layer) {
+    for (size_t view = 0; view < m_views.size(); view++) {
+        selectRanges(layer, view);
+    }
+}
+
+void VectorMap::selectRanges(MapLayer& layer, size_t view) {
+    const ViewState& state = m_views[view];
+    MapLayer::DrawRanges& ranges = layer.drawn[view];
+    
+    // Coarsest level whose error stays below MAX_PIXEL_ERROR at this scale
+    int baseLevel = 0;
+    for (int level = 1; level < LOD_LEVELS; level++) {
+        if (LOD_TOLERANCES[level] * state.viewScale <= MAX_PIXEL_ERROR) {
+            baseLevel = level;
+        }
+    }
+    
+    ranges.firsts.clear();
+    ranges.counts.clear();
+    if (layer.bounds.empty() || layer.cellStarts.empty()) return;
+    
+    // Segments can sit in several cells and several rects; the stamp makes
+    // each one emitted at most once per rebuild
+    if (++layer.visitStamp == 0) {
+        std::fill(layer.visited.begin(), layer.visited.end(), 0);
+        layer.visitStamp = 1;
+    }
+    
+    for (int r = 0; r < state.visibleRectCount; r++) {
+        const Bounds& rect = state.visibleRects[r];
+        const int column0 = gridColumn(rect.minX, GRID_COLUMNS);
+        const int column1 = gridColumn(rect.maxX, GRID_COLUMNS);
+        const int row0 = gridRow(rect.minY, GRID_ROWS);
+        const int row1 = gridRow(rect.maxY, GRID_ROWS);
+        
+        for (int row = row0; row <= row1; row++) {
+            for (int column = column0; column <= column1; column++) {
+                const size_t cell = static_cast<size_t>(row) * GRID_COLUMNS + column;
+                for (uint32_t i = layer.cellStarts[cell]; i < layer.cellStarts[cell + 1]; i++) {
+                    const uint32_t s = layer.cellSegments[i];
+                    if (layer.visited[s] == layer.visitStamp) continue;
+                    layer.visited[s] = layer.visitStamp;
+                    
+                    const Bounds& b = layer.bounds[s];
+                    if (!b.intersects(rect)) continue;
+                    
+                    float extent = std::max(b.maxX - b.minX, b.maxY - b.minY);
+                    int level = std::max(baseLevel, levelForExtent(extent * state.viewScale));
+                    ranges.firsts.push_back(layer.firsts[level][s]);
+                    ranges.counts.push_back(layer.counts[level][s]);
+                }
             }
-            // Start new segment
-            currentSegment.clear();
-            currentSegment.push_back(points[i]);
-        } else {
-            currentSegment.push_back(points[i]);
         }
     }
+}
+
+void VectorMap::selectAll() {
+    for (MapLayer* layer : {&m_coastlines, &m_borders, &m_russiaBorders}) {
+        selectRanges(*layer, m_activeView);
+    }
+}
+
+void VectorMap::setViewScale(float pixelsPerUnit) {
+    ViewState& state = m_views[m_activeView];
+    if (pixelsPerUnit == state.viewScale) return;
+    
+    state.viewScale = pixelsPerUnit;
+    selectAll();
+}
+
+void VectorMap::setVisibleRects(const Bounds* rects, int count) {
+    ViewState& state = m_views[m_activeView];
+    count = std::clamp(count, 0, Renderer::MAX_VISIBLE_RECTS);
+    if (count == state.visibleRectCount &&
+        std::equal(rects, rects + count, state.visibleRects, [](const Bounds& a, const Bounds& b) {
+            return a.minX == b.minX && a.minY == b.minY && a.maxX == b.maxX && a.maxY == b.maxY;
+        })) {
+        return;
+    }
+    
+    std::copy(rects, rects + count, state.visibleRects);
+    state.visibleRectCount = count;
+    selectAll();
+}
+
+void VectorMap::setViewCount(int count) {
+    const size_t previous = m_views.size();
+    const size_t views = static_cast<size_t>(std::max(count, 1));
     
-    // Save final segment
-    if (currentSegment.size() > 1) {
-        output.push_back({currentSegment, color});
+    ViewState world = {};
+    world.viewScale = SCREEN_WIDTH / WORLD_WIDTH;
+    world.visibleRects[0] = Bounds{-WORLD_WIDTH * 0.5f, -WORLD_HEIGHT * 0.5f,
+                                   WORLD_WIDTH * 0.5f, WORLD_HEIGHT * 0.5f};
+    world.visibleRectCount = 1;
+    m_views.resize(views, world);
+    m_activeView = std::min(m_activeView, views - 1);
+    
+    for (MapLayer* layer : {&m_coastlines, &m_borders, &m_russiaBorders}) {
+        layer->drawn.resize(views);
+        for (size_t view = previous; view < views; view++) {
+            selectRanges(*layer, view);
+        }
     }
 }
 
-bool VectorMap::crossesAntimeridian(const Point& p1, const Point& p2) {
-    // Check if the distance between points is more than half the screen width
-    // This indicates a wrap around the antimeridian
-    float dx = std::abs(p2.x - p1.x);
-    return dx > SCREEN_WIDTH * 0.5f;
+void VectorMap::setActiveView(int index) {
+    m_activeView = std::min(static_cast<size_t>(std::max(index, 0)), m_views.size() - 1);
+}
+
+void VectorMap::uploadLayer(MapLayer& layer) {
+    if (!m_renderer->createStaticLines(layer.gpu, layer.points)) return;
+    
+    std::cout << "Uploaded map layer: " << layer.bounds.size() << " segments, "
+              << layer.points.size() << " vertices\n";
+    
+    // Only the GPU copy is drawn from now on
+    layer.points.clear();
+    layer.points.shrink_to_fit();
+}
+
+void VectorMap::drawLayer(const MapLayer& layer) {
+    const MapLayer::DrawRanges& ranges = layer.drawn[m_activeView];
+    m_renderer->drawStaticLinesWithGlow(layer.gpu, ranges.firsts.data(), ranges.counts.data(),
+                                        static_cast<GLsizei>(ranges.firsts.size()), layer.color, 3);
 }
 
 void VectorMap::draw() {
     // Draw coastlines
-    for (const auto& segment : m_coastlines) {
-        m_renderer->drawPathWithGlow(segment.points, segment.color, 3);
-    }
+    drawLayer(m_coastlines);
     
     // Draw country borders (excluding Russia)
-    for (const auto& segment : m_borders) {
-        m_renderer->drawPathWithGlow(segment.points, segment.color, 3);
-    }
+    drawLayer(m_borders);
     
     // Draw Russia last in red
-    for (const auto& segment : m_russiaBorders) {
-        m_renderer->drawPathWithGlow(segment.points, segment.color, 3);
-    }
+    drawLayer(m_russiaBorders);
 }